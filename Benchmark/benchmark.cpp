@@ -0,0 +1,361 @@
+/*
+    Throughput benchmark and regression check for the Solver.
+
+    Every repetition runs Solver::best_move over the same fixed positions for each difficulty and adds up the time spent in the whole call, in
+    SparseSystem::eliminate and in combination generation. The results can be saved as a JSON baseline, and a later run can be compared against that
+    baseline. A phase is reported as a regression when it is slower by more than the threshold and a one-sided Welch's t-test at the 1% level says the
+    difference is not noise.
+
+    The elimination phase was called "rref" while it timed Matrix::rref on a dense logic matrix. Baselines saved then have no "eliminate" phase, and
+    that phase is reported as missing until a new baseline is saved.
+
+    With --batch, each workload is also run as one BoardBatch through Solver::best_moves, and its time is compared with calling best_move on each
+    position. Filling the BoardBatch is not timed. Batch times are not saved in or compared against baselines.
+
+    Launch using: ./MinesweeperBenchmark [--games N] [--reps N] [--save baseline.json] [--compare baseline.json] [--threshold PERCENT] [--batch]
+
+    The exit code is 1 if a comparison found a regression.
+*/
+
+#include "json.hpp"
+#include "workload.hpp"
+#include "../Solver/batch.hpp"
+#include "../Solver/solver.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+static const char* PHASES[] = {"best_move", "eliminate", "combinations"};
+
+struct Options
+{
+    int num_games = 20;
+    int num_reps = 5;
+    double threshold = 5.0;
+    bool batch = false;
+    std::string save_path;
+    std::string compare_path;
+};
+
+// Milliseconds spent in each phase, one entry per repetition.
+struct WorkloadResult
+{
+    int positions;
+    std::map<std::string, std::vector<double> > samples;
+};
+
+struct Summary
+{
+    double mean;
+    double variance;
+    int n;
+};
+
+static Summary summarize(const std::vector<double>& samples)
+{
+    Summary summary{0.0, 0.0, static_cast<int>(samples.size())};
+
+    for(double sample : samples)
+    {
+        summary.mean += sample;
+    }
+    summary.mean /= summary.n;
+
+    for(double sample : samples)
+    {
+        summary.variance += (sample - summary.mean) * (sample - summary.mean);
+    }
+    summary.variance = summary.n > 1 ? summary.variance / (summary.n - 1) : 0.0;
+
+    return summary;
+}
+
+// One-sided critical values of Student's t distribution at the 1% level.
+static double t_critical(double df)
+{
+    static const double table[][2] = {
+        {1, 31.821}, {2, 6.965}, {3, 4.541}, {4, 3.747}, {5, 3.365}, {6, 3.143}, {7, 2.998}, {8, 2.896}, {9, 2.821}, {10, 2.764},
+        {12, 2.681}, {15, 2.602}, {20, 2.528}, {30, 2.457}, {60, 2.390}, {120, 2.358}
+    };
+
+    if(df <= 1)
+    {
+        return table[0][1];
+    }
+    for(size_t i = 1; i < sizeof(table) / sizeof(table[0]); ++i)
+    {
+        if(df <= table[i][0])
+        {
+            double t = (df - table[i - 1][0]) / (table[i][0] - table[i - 1][0]);
+            return table[i - 1][1] + t * (table[i][1] - table[i - 1][1]);
+        }
+    }
+    return 2.326;
+}
+
+// Returns true when current is significantly slower than baseline.
+static bool is_regression(const Summary& baseline, const Summary& current, double threshold)
+{
+    if(baseline.n < 2 || current.n < 2 || current.mean <= baseline.mean * (1.0 + threshold / 100.0))
+    {
+        return false;
+    }
+
+    double a = baseline.variance / baseline.n;
+    double b = current.variance / current.n;
+    if(a + b == 0.0)
+    {
+        return true;
+    }
+
+    double t = (current.mean - baseline.mean) / std::sqrt(a + b);
+    double df = (a + b) * (a + b) / (a * a / (baseline.n - 1) + b * b / (current.n - 1));
+
+    return t > t_critical(df);
+}
+
+static WorkloadResult run_workload(const Workload& workload, int num_reps)
+{
+    WorkloadResult result{static_cast<int>(workload.positions.size()), {}};
+
+    for(int rep = 0; rep < num_reps; ++rep)
+    {
+        Solver s;
+        long long total_ns = 0, eliminate_ns = 0, combinations_ns = 0;
+
+        for(const std::vector<std::vector<int> >& position : workload.positions)
+        {
+            s.best_move(position, workload.num_mines);
+            total_ns += s.last_profile().total_ns;
+            eliminate_ns += s.last_profile().eliminate_ns;
+            combinations_ns += s.last_profile().combinations_ns;
+        }
+
+        result.samples["best_move"].push_back(total_ns / 1e6);
+        result.samples["eliminate"].push_back(eliminate_ns / 1e6);
+        result.samples["combinations"].push_back(combinations_ns / 1e6);
+    }
+
+    return result;
+}
+
+// Milliseconds for best_move on each position and for best_moves on all of them at once, one entry per repetition of each.
+static void run_batch(const Workload& workload, int num_reps, std::vector<double>& single_ms, std::vector<double>& batch_ms)
+{
+    BoardBatch batch(workload.nrows, workload.ncols, workload.positions.size());
+    for(size_t board = 0; board < workload.positions.size(); ++board)
+    {
+        batch.set_board(board, workload.positions[board]);
+    }
+
+    for(int rep = 0; rep < num_reps; ++rep)
+    {
+        Solver single;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(const std::vector<std::vector<int> >& position : workload.positions)
+        {
+            single.best_move(position, workload.num_mines);
+        }
+        single_ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+        Solver batched;
+        start = std::chrono::steady_clock::now();
+        batched.best_moves(batch, workload.num_mines);
+        batch_ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+}
+
+static void save_baseline(const std::string& path, const Options& options, const std::vector<Workload>& workloads, const std::vector<WorkloadResult>& results)
+{
+    std::ofstream file(path);
+
+    file << "{\n  \"games\": " << options.num_games << ",\n  \"repetitions\": " << options.num_reps << ",\n  \"workloads\": {";
+    for(size_t w = 0; w < workloads.size(); ++w)
+    {
+        file << (w ? "," : "") << "\n    \"" << json_escape(workloads[w].name) << "\": {\n      \"positions\": " << results[w].positions;
+        for(const char* phase : PHASES)
+        {
+            file << ",\n      \"" << phase << "\": [";
+            const std::vector<double>& samples = results[w].samples.at(phase);
+            for(size_t i = 0; i < samples.size(); ++i)
+            {
+                file << (i ? ", " : "") << std::setprecision(9) << samples[i];
+            }
+            file << "]";
+        }
+        file << "\n    }";
+    }
+    file << "\n  }\n}\n";
+}
+
+// Print how each phase compares to the baseline. Returns the number of regressions found.
+static int compare_baseline(const JsonValue& baseline, const Options& options, const std::vector<Workload>& workloads, const std::vector<WorkloadResult>& results)
+{
+    int regressions = 0;
+
+    std::cout << "\nComparison against " << options.compare_path << " (threshold " << options.threshold << "%)\n";
+    for(size_t w = 0; w < workloads.size(); ++w)
+    {
+        const JsonValue& entry = baseline["workloads"][workloads[w].name];
+        if(entry.type != JsonValue::OBJECT)
+        {
+            std::cout << std::setw(8) << workloads[w].name << ": not in baseline\n";
+            continue;
+        }
+        if(static_cast<int>(entry["positions"].number) != results[w].positions)
+        {
+            std::cout << std::setw(8) << workloads[w].name << ": baseline was recorded on different positions, rerun with the same --games\n";
+            continue;
+        }
+
+        for(const char* phase : PHASES)
+        {
+            std::vector<double> old_samples;
+            for(const JsonValue& sample : entry[phase].array)
+            {
+                old_samples.push_back(sample.number);
+            }
+            if(old_samples.empty())
+            {
+                std::cout << std::setw(8) << workloads[w].name << std::setw(14) << phase << ": not in baseline, save a new one\n";
+                continue;
+            }
+
+            Summary before = summarize(old_samples);
+            Summary after = summarize(results[w].samples.at(phase));
+            bool regression = is_regression(before, after, options.threshold);
+            double change = before.mean > 0.0 ? (after.mean - before.mean) / before.mean * 100.0 : 0.0;
+
+            std::cout << std::setw(8) << workloads[w].name << std::setw(14) << phase
+                      << std::fixed << std::setprecision(3) << std::setw(12) << before.mean << " ms ->" << std::setw(12) << after.mean << " ms"
+                      << std::showpos << std::setprecision(1) << std::setw(9) << change << "%" << std::noshowpos
+                      << (regression ? "  REGRESSION" : "") << "\n";
+
+            regressions += regression;
+        }
+    }
+
+    return regressions;
+}
+
+static void print_usage_and_exit()
+{
+    std::cout << "Optional args: --games N, --reps N, --save FILE, --compare FILE, --threshold PERCENT, --batch" << std::endl;
+    exit(0);
+}
+
+static Options parse_args(int argc, char **args)
+{
+    Options options;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string cur(args[i]);
+
+        if(cur == "--batch")
+        {
+            options.batch = true;
+            continue;
+        }
+        if(i + 1 >= argc)
+        {
+            print_usage_and_exit();
+        }
+        if(cur == "--games")
+        {
+            options.num_games = std::stoi(args[++i]);
+        }
+        else if(cur == "--reps")
+        {
+            options.num_reps = std::stoi(args[++i]);
+        }
+        else if(cur == "--save")
+        {
+            options.save_path = args[++i];
+        }
+        else if(cur == "--compare")
+        {
+            options.compare_path = args[++i];
+        }
+        else if(cur == "--threshold")
+        {
+            options.threshold = std::stod(args[++i]);
+        }
+        else
+        {
+            print_usage_and_exit();
+        }
+    }
+
+    if(options.num_games < 1 || options.num_reps < 1)
+    {
+        print_usage_and_exit();
+    }
+    return options;
+}
+
+int main(int argc, char **args)
+{
+    Options options = parse_args(argc, args);
+
+    JsonValue baseline;
+    if(!options.compare_path.empty() && !read_json_file(options.compare_path, baseline))
+    {
+        std::cout << "Could not read baseline " << options.compare_path << std::endl;
+        return 2;
+    }
+
+    std::vector<Workload> workloads = build_standard_workloads(options.num_games);
+    std::vector<WorkloadResult> results;
+
+    std::cout << std::setw(8) << "workload" << std::setw(11) << "positions" << std::setw(16) << "best_move ms" << std::setw(11) << "stddev"
+              << std::setw(11) << "elim ms" << std::setw(16) << "combos ms" << std::setw(16) << "positions/s\n";
+    for(const Workload& workload : workloads)
+    {
+        results.push_back(run_workload(workload, options.num_reps));
+
+        Summary total = summarize(results.back().samples["best_move"]);
+        Summary eliminate = summarize(results.back().samples["eliminate"]);
+        Summary combinations = summarize(results.back().samples["combinations"]);
+
+        std::cout << std::fixed << std::setprecision(3)
+                  << std::setw(8) << workload.name << std::setw(11) << results.back().positions << std::setw(16) << total.mean << std::setw(11) << std::sqrt(total.variance)
+                  << std::setw(11) << eliminate.mean << std::setw(16) << combinations.mean
+                  << std::setw(15) << std::setprecision(0) << results.back().positions / (total.mean / 1000.0) << "\n";
+    }
+
+    if(options.batch)
+    {
+        std::cout << "\n" << std::setw(8) << "workload" << std::setw(11) << "positions" << std::setw(16) << "best_move ms" << std::setw(16) << "best_moves ms"
+                  << std::setw(11) << "speedup\n";
+        for(const Workload& workload : workloads)
+        {
+            std::vector<double> single_ms, batch_ms;
+            run_batch(workload, options.num_reps, single_ms, batch_ms);
+
+            Summary single = summarize(single_ms);
+            Summary batch = summarize(batch_ms);
+            std::cout << std::fixed << std::setprecision(3)
+                      << std::setw(8) << workload.name << std::setw(11) << workload.positions.size() << std::setw(16) << single.mean << std::setw(16) << batch.mean
+                      << std::setw(9) << std::setprecision(1) << single.mean / batch.mean << "x\n";
+        }
+    }
+
+    if(!options.save_path.empty())
+    {
+        save_baseline(options.save_path, options, workloads, results);
+        std::cout << "\nSaved baseline to " << options.save_path << "\n";
+    }
+
+    if(!options.compare_path.empty() && compare_baseline(baseline, options, workloads, results) > 0)
+    {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,207 @@
+#include "json.hpp"
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+bool JsonValue::has(const std::string& key) const
+{
+    return type == OBJECT && object.count(key) != 0;
+}
+
+const JsonValue& JsonValue::operator[](const std::string& key) const
+{
+    static const JsonValue null_value;
+    auto it = object.find(key);
+    return it == object.end() ? null_value : it->second;
+}
+
+static void skip_whitespace(const std::string& text, size_t& pos)
+{
+    while(pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos])))
+    {
+        ++pos;
+    }
+}
+
+static bool parse_string(const std::string& text, size_t& pos, std::string& out)
+{
+    if(text[pos] != '"')
+    {
+        return false;
+    }
+    ++pos;
+
+    while(pos < text.size() && text[pos] != '"')
+    {
+        if(text[pos] == '\\' && pos + 1 < text.size())
+        {
+            ++pos;
+            switch(text[pos])
+            {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                default: out += text[pos]; break;
+            }
+        }
+        else
+        {
+            out += text[pos];
+        }
+        ++pos;
+    }
+    if(pos >= text.size())
+    {
+        return false;
+    }
+    ++pos;
+    return true;
+}
+
+static bool parse_value(const std::string& text, size_t& pos, JsonValue& value)
+{
+    skip_whitespace(text, pos);
+    if(pos >= text.size())
+    {
+        return false;
+    }
+
+    if(text[pos] == '{')
+    {
+        value.type = JsonValue::OBJECT;
+        ++pos;
+        skip_whitespace(text, pos);
+        if(pos < text.size() && text[pos] == '}')
+        {
+            ++pos;
+            return true;
+        }
+        while(pos < text.size())
+        {
+            std::string key;
+            skip_whitespace(text, pos);
+            if(!parse_string(text, pos, key))
+            {
+                return false;
+            }
+            skip_whitespace(text, pos);
+            if(pos >= text.size() || text[pos++] != ':')
+            {
+                return false;
+            }
+            if(!parse_value(text, pos, value.object[key]))
+            {
+                return false;
+            }
+            skip_whitespace(text, pos);
+            if(pos < text.size() && text[pos] == ',')
+            {
+                ++pos;
+            }
+            else if(pos < text.size() && text[pos] == '}')
+            {
+                ++pos;
+                return true;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return false;
+    }
+    else if(text[pos] == '[')
+    {
+        value.type = JsonValue::ARRAY;
+        ++pos;
+        skip_whitespace(text, pos);
+        if(pos < text.size() && text[pos] == ']')
+        {
+            ++pos;
+            return true;
+        }
+        while(pos < text.size())
+        {
+            value.array.emplace_back();
+            if(!parse_value(text, pos, value.array.back()))
+            {
+                return false;
+            }
+            skip_whitespace(text, pos);
+            if(pos < text.size() && text[pos] == ',')
+            {
+                ++pos;
+            }
+            else if(pos < text.size() && text[pos] == ']')
+            {
+                ++pos;
+                return true;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return false;
+    }
+    else if(text[pos] == '"')
+    {
+        value.type = JsonValue::STRING;
+        return parse_string(text, pos, value.string);
+    }
+    else if(text.compare(pos, 4, "null") == 0)
+    {
+        value.type = JsonValue::NUL;
+        pos += 4;
+        return true;
+    }
+
+    const char* begin = text.c_str() + pos;
+    char* end;
+    value.type = JsonValue::NUMBER;
+    value.number = std::strtod(begin, &end);
+    if(end == begin)
+    {
+        return false;
+    }
+    pos += end - begin;
+    return true;
+}
+
+bool parse_json(const std::string& text, JsonValue& value)
+{
+    size_t pos = 0;
+    if(!parse_value(text, pos, value))
+    {
+        return false;
+    }
+    skip_whitespace(text, pos);
+    return pos == text.size();
+}
+
+bool read_json_file(const std::string& path, JsonValue& value)
+{
+    std::ifstream file(path);
+    if(!file)
+    {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return parse_json(buffer.str(), value);
+}
+
+std::string json_escape(const std::string& s)
+{
+    std::string out;
+    for(char c : s)
+    {
+        if(c == '"' || c == '\\')
+        {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out;
+}
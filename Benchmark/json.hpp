@@ -0,0 +1,28 @@
+/*
+    Just enough JSON to store benchmark baselines: numbers, strings, arrays and objects. Reading is a small recursive descent parser that rejects
+    anything it does not understand, writing is left to the caller.
+*/
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+struct JsonValue
+{
+    enum Type {NUL, NUMBER, STRING, ARRAY, OBJECT};
+
+    Type type = NUL;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::map<std::string, JsonValue> object;
+
+    bool has(const std::string& key) const;
+    const JsonValue& operator[](const std::string& key) const;
+};
+
+bool parse_json(const std::string& text, JsonValue& value);
+bool read_json_file(const std::string& path, JsonValue& value);
+std::string json_escape(const std::string& s);
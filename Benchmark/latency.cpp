@@ -0,0 +1,175 @@
+/*
+    Latency benchmark for the Solver.
+
+    Replays the same fixed positions as MinesweeperBenchmark for each difficulty, calling Solver::best_move once per position per repetition, and reports
+    the distribution of single-call times rather than totals. The phases of best_move are reported on their own as well, so a slow tail can be traced to
+    the part of the Solver it comes from. find_safest_move only runs when no guaranteed move exists, so its distribution is over fewer calls.
+
+    Launch using: ./MinesweeperLatency [--games N] [--reps N] [--threads N] [--budget US]
+
+    With --budget, every call is given that many microseconds to search for probabilities instead of the Solver's usual node limit.
+
+    All times are in microseconds.
+*/
+
+#include "workload.hpp"
+#include "../Solver/solver.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct Options
+{
+    int num_games = 20;
+    int num_reps = 5;
+    int num_threads = 1;
+    int budget_us = 0;
+};
+
+// Single-call times of one phase, in nanoseconds.
+struct Phase
+{
+    const char* name;
+    long long SolverProfile::*field;
+    std::vector<long long> samples;
+};
+
+// Nearest-rank percentile of sorted samples.
+static long long percentile(const std::vector<long long>& sorted, double p)
+{
+    int rank = static_cast<int>(std::ceil(p / 100.0 * sorted.size()));
+    return sorted[std::max(rank, 1) - 1];
+}
+
+static void print_phase(const std::string& workload, Phase& phase)
+{
+    std::cout << std::setw(8) << workload << std::setw(14) << phase.name << std::setw(9) << phase.samples.size();
+
+    if(phase.samples.empty())
+    {
+        std::cout << "\n";
+        return;
+    }
+
+    std::sort(phase.samples.begin(), phase.samples.end());
+    std::cout << std::fixed << std::setprecision(1);
+    for(double p : {50.0, 90.0, 99.0})
+    {
+        std::cout << std::setw(12) << percentile(phase.samples, p) / 1e3;
+    }
+    std::cout << std::setw(12) << phase.samples.back() / 1e3 << "\n";
+}
+
+static void run_workload(const Workload& workload, const Options& options)
+{
+    std::vector<Phase> phases = {
+        {"best_move", &SolverProfile::total_ns, {}},
+        {"trivial", &SolverProfile::trivial_ns, {}},
+        {"pattern", &SolverProfile::pattern_ns, {}},
+        {"propagation", &SolverProfile::propagation_ns, {}},
+        {"logic_matrix", &SolverProfile::logic_matrix_ns, {}},
+        {"eliminate", &SolverProfile::eliminate_ns, {}},
+        {"guaranteed", &SolverProfile::guaranteed_ns, {}},
+        {"safest", &SolverProfile::safest_ns, {}},
+    };
+
+    for(int rep = 0; rep < options.num_reps; ++rep)
+    {
+        Solver s;
+        s.set_num_threads(options.num_threads);
+
+        for(const std::vector<std::vector<int> >& position : workload.positions)
+        {
+            if(options.budget_us > 0)
+            {
+                s.best_move(position, workload.num_mines, std::chrono::microseconds(options.budget_us));
+            }
+            else
+            {
+                s.best_move(position, workload.num_mines);
+            }
+            const SolverProfile& profile = s.last_profile();
+
+            phases[0].samples.push_back(profile.total_ns);
+            for(size_t i = 1; i < phases.size(); ++i)
+            {
+                // A phase that was skipped records no time at all.
+                if(profile.*phases[i].field > 0)
+                {
+                    phases[i].samples.push_back(profile.*phases[i].field);
+                }
+            }
+        }
+    }
+
+    for(Phase& phase : phases)
+    {
+        print_phase(workload.name, phase);
+    }
+}
+
+static void print_usage_and_exit()
+{
+    std::cout << "Optional args: --games N, --reps N, --threads N, --budget US" << std::endl;
+    exit(0);
+}
+
+static Options parse_args(int argc, char **args)
+{
+    Options options;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string cur(args[i]);
+
+        if(i + 1 >= argc)
+        {
+            print_usage_and_exit();
+        }
+        if(cur == "--games")
+        {
+            options.num_games = std::stoi(args[++i]);
+        }
+        else if(cur == "--reps")
+        {
+            options.num_reps = std::stoi(args[++i]);
+        }
+        else if(cur == "--threads")
+        {
+            options.num_threads = std::stoi(args[++i]);
+        }
+        else if(cur == "--budget")
+        {
+            options.budget_us = std::stoi(args[++i]);
+        }
+        else
+        {
+            print_usage_and_exit();
+        }
+    }
+
+    if(options.num_games < 1 || options.num_reps < 1 || options.num_threads < 1 || options.budget_us < 0)
+    {
+        print_usage_and_exit();
+    }
+    return options;
+}
+
+int main(int argc, char **args)
+{
+    Options options = parse_args(argc, args);
+
+    std::cout << std::setw(8) << "workload" << std::setw(14) << "phase" << std::setw(9) << "calls"
+              << std::setw(12) << "p50 us" << std::setw(12) << "p90 us" << std::setw(12) << "p99 us" << std::setw(12) << "max us\n";
+    for(const Workload& workload : build_standard_workloads(options.num_games))
+    {
+        run_workload(workload, options);
+    }
+
+    return 0;
+}
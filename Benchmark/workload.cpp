@@ -0,0 +1,132 @@
+#include "workload.hpp"
+
+#include "../Minesweeper/difficulty.hpp"
+
+#include <algorithm>
+#include <random>
+#include <utility>
+
+// Reveal a cell the way the game does, continuing through cells with a hint of 0.
+static void reveal(std::vector<std::vector<int> >& position, const std::vector<std::vector<int> >& hints, int x, int y)
+{
+    std::vector<std::pair<int, int> > stack{{x, y}};
+    int nrows = position.size();
+    int ncols = position[0].size();
+
+    while(!stack.empty())
+    {
+        std::pair<int, int> cell = stack.back();
+        stack.pop_back();
+
+        if(position[cell.first][cell.second] != -1)
+        {
+            continue;
+        }
+        position[cell.first][cell.second] = hints[cell.first][cell.second];
+
+        if(hints[cell.first][cell.second] != 0)
+        {
+            continue;
+        }
+        for(int row = cell.first - 1; row <= cell.first + 1; ++row)
+        {
+            for(int col = cell.second - 1; col <= cell.second + 1; ++col)
+            {
+                if(row >= 0 && row < nrows && col >= 0 && col < ncols && position[row][col] == -1)
+                {
+                    stack.push_back({row, col});
+                }
+            }
+        }
+    }
+}
+
+Workload build_workload(const std::string& name, int nrows, int ncols, int num_mines, int num_games, unsigned int seed)
+{
+    Workload workload{name, nrows, ncols, num_mines, {}};
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> row_rand(0, nrows - 1);
+    std::uniform_int_distribution<int> col_rand(0, ncols - 1);
+
+    for(int game = 0; game < num_games; ++game)
+    {
+        std::vector<std::vector<bool> > mines(nrows, std::vector<bool>(ncols));
+        std::vector<std::vector<int> > hints(nrows, std::vector<int>(ncols));
+        std::vector<std::vector<int> > position(nrows, std::vector<int>(ncols, -1));
+
+        // The first move is always the top-left cell, so keep it clear as the game does.
+        for(int placed = 0; placed < num_mines; )
+        {
+            int row = row_rand(gen);
+            int col = col_rand(gen);
+            if(!mines[row][col] && !(row == 0 && col == 0))
+            {
+                mines[row][col] = true;
+                ++placed;
+            }
+        }
+
+        std::vector<std::pair<int, int> > safe_cells;
+        for(int row = 0; row < nrows; ++row)
+        {
+            for(int col = 0; col < ncols; ++col)
+            {
+                for(int r = row - 1; r <= row + 1; ++r)
+                {
+                    for(int c = col - 1; c <= col + 1; ++c)
+                    {
+                        if(r >= 0 && r < nrows && c >= 0 && c < ncols && mines[r][c])
+                        {
+                            ++hints[row][col];
+                        }
+                    }
+                }
+                if(!mines[row][col])
+                {
+                    safe_cells.push_back({row, col});
+                }
+            }
+        }
+
+        workload.positions.push_back(position);
+        reveal(position, hints, 0, 0);
+
+        // Keep revealing random safe cells until only one is left, recording the board before each one.
+        std::shuffle(safe_cells.begin(), safe_cells.end(), gen);
+        int remaining = 0;
+        for(std::pair<int, int>& cell : safe_cells)
+        {
+            remaining += position[cell.first][cell.second] == -1;
+        }
+        for(std::pair<int, int>& cell : safe_cells)
+        {
+            if(remaining <= 1)
+            {
+                break;
+            }
+            if(position[cell.first][cell.second] != -1)
+            {
+                continue;
+            }
+            workload.positions.push_back(position);
+            reveal(position, hints, cell.first, cell.second);
+
+            remaining = 0;
+            for(std::pair<int, int>& other : safe_cells)
+            {
+                remaining += position[other.first][other.second] == -1;
+            }
+        }
+    }
+
+    return workload;
+}
+
+std::vector<Workload> build_standard_workloads(int num_games)
+{
+    return {
+        build_workload("easy", EASY_DIMENSIONS.first, EASY_DIMENSIONS.second, EASY_NUM_MINES, num_games, 1),
+        build_workload("medium", MEDIUM_DIMENSIONS.first, MEDIUM_DIMENSIONS.second, MEDIUM_NUM_MINES, num_games, 2),
+        build_workload("hard", HARD_DIMENSIONS.first, HARD_DIMENSIONS.second, HARD_NUM_MINES, num_games, 3),
+    };
+}
@@ -0,0 +1,23 @@
+/*
+    Fixed sets of board positions used to measure the Solver.
+
+    Positions are recorded from seeded games that are played by revealing random safe cells, not by the Solver itself. That way the positions stay the
+    same when the Solver changes, and timings from different builds can be compared directly.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct Workload
+{
+    std::string name;
+    int nrows;
+    int ncols;
+    int num_mines;
+    std::vector<std::vector<std::vector<int> > > positions;
+};
+
+Workload build_workload(const std::string& name, int nrows, int ncols, int num_mines, int num_games, unsigned int seed);
+std::vector<Workload> build_standard_workloads(int num_games);
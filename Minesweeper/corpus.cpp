@@ -0,0 +1,195 @@
+#include "corpus.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+static const char CORPUS_MAGIC[8] = {'M', 'S', 'C', 'O', 'R', 'P', 'U', 'S'};
+
+static void put_le(uint8_t* out, uint64_t value, int num_bytes)
+{
+    for(int i = 0; i < num_bytes; ++i)
+    {
+        out[i] = value >> (8 * i);
+    }
+}
+
+static uint64_t get_le(const uint8_t* in, int num_bytes)
+{
+    uint64_t value = 0;
+    for(int i = 0; i < num_bytes; ++i)
+    {
+        value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+// Write num_boards boards of num_mines uniformly placed mines each. Board i is drawn from stream i of rng, so any board can be regenerated on its own.
+bool write_corpus(const std::string& path, int nrows, int ncols, int num_mines, uint64_t num_boards, const Rng& rng)
+{
+    std::ofstream file(path, std::ios::binary);
+    if(!file || nrows < 1 || ncols < 1 || nrows > 0xffff || ncols > 0xffff || num_mines < 0 || num_mines > nrows * ncols)
+    {
+        return false;
+    }
+
+    uint8_t header[CORPUS_HEADER_SIZE] = {};
+    std::memcpy(header, CORPUS_MAGIC, sizeof(CORPUS_MAGIC));
+    put_le(header + 8, CORPUS_VERSION, 4);
+    put_le(header + 12, nrows, 2);
+    put_le(header + 14, ncols, 2);
+    put_le(header + 16, num_mines, 4);
+    put_le(header + 24, num_boards, 8);
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    int num_cells = nrows * ncols;
+    std::vector<uint8_t> board((num_cells + 7) / 8);
+
+    for(uint64_t i = 0; i < num_boards; ++i)
+    {
+        Rng board_rng = rng.stream(i);
+        std::fill(board.begin(), board.end(), 0);
+
+        for(int placed = 0; placed < num_mines;)
+        {
+            int cell = board_rng.uniform(num_cells);
+            if(!((board[cell / 8] >> (cell % 8)) & 1))
+            {
+                board[cell / 8] |= 1 << (cell % 8);
+                ++placed;
+            }
+        }
+
+        file.write(reinterpret_cast<const char*>(board.data()), board.size());
+    }
+
+    return static_cast<bool>(file);
+}
+
+BoardCorpus::BoardCorpus()
+{
+    data = nullptr;
+    length = 0;
+    rows = 0;
+    cols = 0;
+    mines = 0;
+    boards = 0;
+}
+
+BoardCorpus::~BoardCorpus()
+{
+    if(data)
+    {
+        munmap(const_cast<uint8_t*>(data), length);
+    }
+}
+
+// Map a corpus file into memory and check its header. Returns false if the file can't be read or isn't a complete corpus.
+bool BoardCorpus::open(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if(fstat(fd, &info) != 0 || info.st_size < CORPUS_HEADER_SIZE)
+    {
+        close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED)
+    {
+        return false;
+    }
+    madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+
+    if(data)
+    {
+        munmap(const_cast<uint8_t*>(data), length);
+    }
+    data = static_cast<const uint8_t*>(mapping);
+    length = info.st_size;
+
+    rows = get_le(data + 12, 2);
+    cols = get_le(data + 14, 2);
+    uint64_t header_mines = get_le(data + 16, 4);
+    boards = get_le(data + 24, 8);
+
+    // The mine count is checked before it is narrowed, so a count of 2^31 or more can't pass as negative
+    bool valid = std::memcmp(data, CORPUS_MAGIC, sizeof(CORPUS_MAGIC)) == 0 && get_le(data + 8, 4) == static_cast<uint64_t>(CORPUS_VERSION)
+                 && rows > 0 && cols > 0 && header_mines <= static_cast<uint64_t>(rows) * cols && boards <= (length - CORPUS_HEADER_SIZE) / board_size();
+    mines = valid ? header_mines : 0;
+    if(!valid)
+    {
+        boards = 0;
+    }
+    return valid;
+}
+
+/*
+    Check that every board has as many mines as the header says, which open leaves alone so that opening stays free. Returns the index of the first
+    board that doesn't, or size() if they all do.
+
+    Game counts the mines of a layout itself, but the Solver is told the header's count, so a board that disagrees would be solved for the wrong number
+    of mines. Padding bits past the last cell count as mines here, so a board with any set is rejected too.
+*/
+uint64_t BoardCorpus::check_layouts()
+{
+    size_t bytes = board_size();
+    for(uint64_t index = 0; index < boards; ++index)
+    {
+        const uint8_t* board = layout(index);
+        int count = 0;
+        for(size_t i = 0; i < bytes; ++i)
+        {
+            count += __builtin_popcount(board[i]);
+        }
+        if(count != mines)
+        {
+            return index;
+        }
+    }
+    return boards;
+}
+
+int BoardCorpus::nrows()
+{
+    return rows;
+}
+
+int BoardCorpus::ncols()
+{
+    return cols;
+}
+
+int BoardCorpus::num_mines()
+{
+    return mines;
+}
+
+uint64_t BoardCorpus::size()
+{
+    return boards;
+}
+
+// Bytes taken by each board.
+size_t BoardCorpus::board_size()
+{
+    return (static_cast<size_t>(rows) * cols + 7) / 8;
+}
+
+// The mines of board index, pointing straight into the mapped file.
+const uint8_t* BoardCorpus::layout(uint64_t index)
+{
+    return data + CORPUS_HEADER_SIZE + index * board_size();
+}
@@ -0,0 +1,63 @@
+/*
+    A file of mine layouts, so that different builds of the Solver can be run on exactly the same boards.
+
+    The file starts with a 32 byte header, with every field little-endian:
+        bytes  0-7   magic "MSCORPUS"
+        bytes  8-11  format version, currently 1
+        bytes 12-13  number of rows
+        bytes 14-15  number of columns
+        bytes 16-19  number of mines on every board
+        bytes 20-23  reserved, 0
+        bytes 24-31  number of boards
+    Each board follows as (rows * columns + 7) / 8 bytes, with bit row * columns + col set if that cell is a mine. Bits are counted from the lowest bit of
+    the first byte, as Game expects.
+
+    A BoardCorpus maps the file into memory rather than reading it, so boards are read straight from the page cache and a corpus of millions of boards
+    costs nothing to open. open only checks the header, which must have between 0 and rows * columns mines. check_layouts reads every board to check
+    that it has that many.
+*/
+
+#pragma once
+
+#include "../Solver/rng.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+const int CORPUS_VERSION = 1;
+const int CORPUS_HEADER_SIZE = 32;
+
+bool write_corpus(const std::string& path, int nrows, int ncols, int num_mines, uint64_t num_boards, const Rng& rng);
+
+class BoardCorpus
+{
+    private:
+
+    const uint8_t* data;
+    size_t length;
+
+    int rows;
+    int cols;
+    int mines;
+    uint64_t boards;
+
+    public:
+
+    BoardCorpus();
+    ~BoardCorpus();
+
+    // A corpus owns its mapping and unmaps it when destroyed, so it can't be copied
+    BoardCorpus(const BoardCorpus&) = delete;
+    BoardCorpus& operator=(const BoardCorpus&) = delete;
+
+    bool open(const std::string& path);
+    uint64_t check_layouts();
+
+    int nrows();
+    int ncols();
+    int num_mines();
+    uint64_t size();
+    size_t board_size();
+    const uint8_t* layout(uint64_t index);
+};
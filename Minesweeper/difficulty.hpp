@@ -0,0 +1,18 @@
+/*
+    Board dimensions and mine counts for the standard difficulties, as in the Windows XP version of the game.
+*/
+
+#pragma once
+
+#include <utility>
+
+enum {EASY, MEDIUM, HARD};
+
+const std::pair<int, int> EASY_DIMENSIONS{8, 8};
+const int EASY_NUM_MINES = 10;
+
+const std::pair<int, int> MEDIUM_DIMENSIONS{16, 16};
+const int MEDIUM_NUM_MINES = 40;
+
+const std::pair<int, int> HARD_DIMENSIONS{16, 30};
+const int HARD_NUM_MINES = 99;
@@ -0,0 +1,292 @@
+#include "game.hpp"
+
+#include <iostream>
+
+const uint8_t Game::BORDER;
+
+// Used for printing out hints.
+static const char hint_character_set[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8'};
+
+// Generate a new grid of Minesweeper.
+Game::Game(int nrows, int ncols, int num_mines, const Rng& rng) : rng(rng)
+{
+    max_mines = num_mines;
+    this->nrows = nrows;
+    this->ncols = ncols;
+    stride = ncols + 2;
+
+    // Every cell starts hidden, and the cells around the edge are border sentinels
+    grid = std::vector<uint8_t>((nrows + 2) * stride, BORDER);
+    for(int row = 0; row < nrows; ++row)
+    {
+        for(int col = 0; col < ncols; ++col)
+        {
+            grid[index(row, col)] = HIDDEN;
+        }
+    }
+
+    int offset = 0;
+    for(int offset_x = -1; offset_x < 2; ++offset_x)
+    {
+        for(int offset_y = -1; offset_y < 2; ++offset_y)
+        {
+            if(offset_x != 0 || offset_y != 0)
+            {
+                neighbor_offsets[offset++] = offset_x * stride + offset_y;
+            }
+        }
+    }
+
+    queued = std::vector<uint64_t>((grid.size() + 63) / 64);
+    stack = std::vector<int>(nrows * ncols);
+
+    game_won = false;
+    game_lost = false;
+    first_move = true;
+    preset_mines = false;
+    hidden_cells = nrows * ncols;
+}
+
+// Set up a grid with the given mines. Bit row * ncols + col of layout, counting from the lowest bit of the first byte, is set if that cell is a mine.
+Game::Game(int nrows, int ncols, const uint8_t* layout) : Game(nrows, ncols, 0, Rng(0))
+{
+    for(int row = 0; row < nrows; ++row)
+    {
+        for(int col = 0; col < ncols; ++col)
+        {
+            int bit = row * ncols + col;
+            if((layout[bit / 8] >> (bit % 8)) & 1)
+            {
+                grid[index(row, col)] |= MINE;
+                ++max_mines;
+            }
+        }
+    }
+
+    preset_mines = true;
+}
+
+Game::~Game()
+{
+
+}
+
+// Obtain number of mines that are adjacent to the given cell of the grid
+int Game::get_num_adjacent_mines(int cell)
+{
+    int total = 0;
+
+    for(int offset : neighbor_offsets)
+    {
+        total += (grid[cell + offset] & MINE) != 0;
+    }
+
+    return total;
+}
+
+// Reveals starting Cell, and continues revealing all hint Cells of value 0.
+void Game::reveal_adjacent_safe_cells(int x, int y)
+{
+    int top = 0;
+
+    stack[top++] = index(x, y);
+    set_queued(index(x, y));
+
+    while(top > 0)
+    {
+        int cell = stack[--top];
+
+        grid[cell] &= ~HIDDEN;
+        revealed_cells.push_back({cell / stride - 1, cell % stride - 1});
+        --hidden_cells;
+
+        if((grid[cell] & HINT_MASK) != 0)
+        {
+            continue;
+        }
+
+        // Border cells are never hidden, so the fill stops at the edge of the grid without checking bounds
+        for(int offset : neighbor_offsets)
+        {
+            int neighbor = cell + offset;
+            if((grid[neighbor] & (HIDDEN | MINE)) == HIDDEN && !is_queued(neighbor))
+            {
+                set_queued(neighbor);
+                stack[top++] = neighbor;
+            }
+        }
+    }
+}
+
+// Randomly assign Cells to contain mines, leaving out the cell picked for the initial move.
+void Game::place_random_mines(int initial_x, int initial_y)
+{
+    int row, col;
+    int cur_mines = 0;
+
+    while(cur_mines < max_mines)
+    {
+        row = rng.uniform(nrows);
+        col = rng.uniform(ncols);
+
+        // If the current cell is not already a mine, or was the cell picked for the initial move
+        if( !(grid[index(row, col)] & MINE) && !(row == initial_x && col == initial_y))
+        {
+            grid[index(row, col)] |= MINE;
+            ++cur_mines;
+        }
+    }
+}
+
+// Move the mine at the given cell to the first cell without a mine, scanning rows from the top-left corner.
+void Game::move_mine_from(int x, int y)
+{
+    for(int row = 0; row < nrows; ++row)
+    {
+        for(int col = 0; col < ncols; ++col)
+        {
+            if(!(grid[index(row, col)] & MINE) && !(row == x && col == y))
+            {
+                grid[index(row, col)] |= MINE;
+                grid[index(x, y)] &= ~MINE;
+                return;
+            }
+        }
+    }
+}
+
+// Make first move of the game, marking initial cell and generating mines and hints.
+// Ensures that the cell chosen as the initial move of the game is not a mine so that the player can not lose on the first turn.
+void Game::make_first_move(int initial_x, int initial_y)
+{
+    if(!preset_mines)
+    {
+        place_random_mines(initial_x, initial_y);
+    }
+    else if(grid[index(initial_x, initial_y)] & MINE)
+    {
+        move_mine_from(initial_x, initial_y);
+    }
+
+    // Assign the value of hint Cells according to the number of mines adjacent to them
+    for(int row = 0; row < nrows; ++row)
+    {
+        for(int col = 0; col < ncols; ++col)
+        {
+            int cell = index(row, col);
+            if(!(grid[cell] & MINE))
+            {
+                grid[cell] = (grid[cell] & ~HINT_MASK) | get_num_adjacent_mines(cell);
+            }
+        }
+    }
+
+}
+
+// Reveals all Cells
+void Game::reveal_grid()
+{
+    for(uint8_t& cell : grid)
+    {
+        cell &= ~HIDDEN;
+    }
+}
+
+void Game::make_move(int x, int y)
+{
+    if(x < 0 || x >= nrows || y < 0 || y >= ncols || !(grid[index(x, y)] & HIDDEN))
+    {
+        return;
+    }
+
+    if(first_move)
+    {
+        first_move = false;
+        make_first_move(x, y);
+        reveal_adjacent_safe_cells(x, y);
+    }
+    else if(grid[index(x, y)] & MINE)
+    {
+        game_lost = true;
+        reveal_grid();
+    }
+    else
+    {
+        reveal_adjacent_safe_cells(x, y);
+    }
+
+    if(max_mines >= hidden_cells)
+    {
+        game_won = true;
+        reveal_grid();
+    }
+}
+
+bool Game::won()
+{
+    return game_won;
+}
+
+bool Game::lost()
+{
+    return game_lost;
+}
+
+int Game::hint(int x, int y)
+{
+    return grid[index(x, y)] & HINT_MASK;
+}
+
+// Hand over every cell revealed since the last call.
+std::vector<std::pair<int, int> > Game::take_revealed_cells()
+{
+    std::vector<std::pair<int, int> > cells;
+    cells.swap(revealed_cells);
+    return cells;
+}
+
+void Game::print()
+{
+    for(int row = 0; row < nrows; ++row)
+    {
+        for(int col = 0; col < ncols; ++col)
+        {
+            uint8_t cell = grid[index(row, col)];
+
+            if(cell & HIDDEN)
+            {
+                std::cout << "# ";
+            }
+            else if(cell & MINE)
+            {
+                std::cout << "M ";
+            }
+            else
+            {
+                std::cout << hint_character_set[cell & HINT_MASK] << " ";
+            }
+        }
+        std::cout << std::endl;
+    }
+}
+
+void Game::debug_print()
+{
+    for(int row = 0; row < nrows; ++row)
+    {
+        for(int col = 0; col < ncols; ++col)
+        {
+            uint8_t cell = grid[index(row, col)];
+
+            if(cell & MINE)
+            {
+                std::cout << "M ";
+            }
+            else
+            {
+                std::cout << hint_character_set[cell & HINT_MASK] << " ";
+            }
+        }
+        std::cout << std::endl;
+    }
+}
@@ -0,0 +1,74 @@
+/*
+    A single game of Minesweeper. All of the state for a game lives in the Game object, so any number of games can be played side by side.
+
+    Mines are placed when the first move is made, so that the first move is never a mine. They are placed using the Rng the game was created with, so
+    the same Rng always gives the same game for the same first move. A game can also be created from a fixed layout of mines, such as one from a
+    BoardCorpus. If the first move of such a game hits a mine, the mine is moved to the first free cell from the top-left corner, as in Windows.
+    Every cell revealed by a move is recorded until it is collected with take_revealed_cells(), which is how the Solver is kept up to date.
+
+    The grid is a flat array of one byte per cell, surrounded by a border of sentinel cells so that neighbors can be found by adding a fixed offset
+    without bounds checks. Revealing a region of 0 hints is a stack-based flood fill that marks cells in a bitmap as they are queued, so every cell is
+    looked at a constant number of times however large the region is.
+*/
+
+#pragma once
+
+#include "../Solver/rng.hpp"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class Game
+{
+    private:
+
+    // Each cell holds its hint in the low four bits, and these flags.
+    static const uint8_t HINT_MASK = 0x0f;
+    static const uint8_t MINE = 0x10;
+    static const uint8_t HIDDEN = 0x20;
+    static const uint8_t BORDER = 0x40;
+
+    int nrows;
+    int ncols;
+    int stride;         // Cells per row of the grid, including the border on both sides
+    int max_mines;
+    int hidden_cells;
+    int neighbor_offsets[8];
+    std::vector<uint8_t> grid;
+    std::vector<uint64_t> queued;   // Bit set once a cell has been pushed onto the flood fill stack
+    std::vector<int> stack;         // Room for every cell, since each one is pushed at most once
+    std::vector<std::pair<int, int> > revealed_cells; // Cells revealed since they were last collected
+
+    bool game_won;
+    bool game_lost;
+    bool first_move;
+    bool preset_mines;
+    Rng rng;
+
+    int index(int x, int y) { return (x + 1) * stride + y + 1; }
+    bool is_queued(int cell) { return (queued[cell / 64] >> (cell % 64)) & 1; }
+    void set_queued(int cell) { queued[cell / 64] |= uint64_t(1) << (cell % 64); }
+
+    int get_num_adjacent_mines(int cell);
+    void reveal_adjacent_safe_cells(int x, int y);
+    void make_first_move(int initial_x, int initial_y);
+    void place_random_mines(int initial_x, int initial_y);
+    void move_mine_from(int x, int y);
+    void reveal_grid();
+
+    public:
+
+    Game(int nrows, int ncols, int num_mines, const Rng& rng);
+    Game(int nrows, int ncols, const uint8_t* layout);
+    ~Game();
+
+    void make_move(int x, int y);
+    bool won();
+    bool lost();
+    int hint(int x, int y);
+    std::vector<std::pair<int, int> > take_revealed_cells();
+
+    void print();
+    void debug_print();
+};
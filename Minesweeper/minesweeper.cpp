@@ -5,375 +5,192 @@
 
     Launch using: ./MinesweeperSolver.exe -[easy/med/hard]                          for a manual game
     Launch using: ./MinesweeperSolver.exe -a [number of games] -[easy/med/hard]     for a given number of games to be played automatically by the solver, with statistics at the end.
+    Add -j [number of threads] to an automatic run to play that many games at once.
+    Add -t [number of threads] to let the Solver search large groups of frontier cells with that many threads.
+    Add -s [seed] to replay the same games, and the same Solver moves, as an earlier run. An automatic run prints the seed it used.
+    Add -m [file] to an automatic run to write statistics about every Solver call to a file, as CSV if the file name ends in .csv and as JSON otherwise.
+
+    Launch using: ./MinesweeperSolver.exe -g [file] [number of boards] -[easy/med/hard]    to write a corpus of boards to a file, see corpus.hpp.
+    Launch using: ./MinesweeperSolver.exe -c [file]                                        to have the solver play every board in a corpus.
 
     In a manual game, when prompted for a move type "m" and press enter. Then give a move as "row col", such as "2 5" for row 2, column 5. Enter anything other than "m" for the solver to make a move.
 */
 
-#include "../Solver/solver.hpp"
+#include "corpus.hpp"
+#include "difficulty.hpp"
+#include "game.hpp"
+#include "../Solver/session.hpp"
 
-#include <algorithm>
+#include <atomic>
 #include <cctype>
-#include <deque>
+#include <cstdint>
+#include <fstream>
 #include <iostream>
-#include <random>
+#include <limits>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <termios.h>
+#include <thread>
 #include <utility>
 #include <vector>
 
-struct Cell{
-    bool hidden;
-    bool mine;
-    int hint;
-};
-
-// Used for printing out hints.
-static const char hint_character_set[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8'};
-
-enum {EASY, MEDIUM, HARD};
-
-const std::pair<int, int> EASY_DIMENSIONS{8, 8};
-const int EASY_NUM_MINES = 10;
-
-const std::pair<int, int> MEDIUM_DIMENSIONS{16, 16};
-const int MEDIUM_NUM_MINES = 40;
-
-const std::pair<int, int> HARD_DIMENSIONS{16, 30};
-const int HARD_NUM_MINES = 99;
-
-
 bool automatic = false;
 int num_rounds;
+int num_threads = 1;
+int num_solver_threads = 1;
 int difficulty = HARD;
+bool seeded = false;
+uint64_t seed;
+std::string corpus_path;
+bool generate_corpus = false;
+uint64_t corpus_size;
+std::string metrics_path;
 
-int max_mines;
-int hidden_cells;
-int grid_nrows;
-int grid_ncols;
-std::vector<std::vector<Cell> > grid;
-
-bool game_won;
-bool game_lost;
-bool first_move;
-
-void DEBUG_print()
-{
-    for(int row = 0; row < grid_nrows; ++row)
-    {
-        for(int col = 0; col < grid_ncols; ++col)
-        {
-            if(grid.at(row).at(col).mine)
-            {
-                std::cout << "M ";
-            }
-            else
-            {
-                std::cout << hint_character_set[grid.at(row).at(col).hint] << " ";
-            }
-        }
-        std::cout << std::endl;
-    }
-}
-
-std::vector<std::pair<int, int> > get_adjacent_indexes(int x, int y)
-{
-    int cur_x = 0, cur_y = 0;
-    std::vector<std::pair<int, int> > indexes;
-
-    for(int offset_x = -1; offset_x < 2; ++offset_x)
-    {
-        for(int offset_y = -1; offset_y < 2; ++offset_y)
-        {
-            cur_x = x + offset_x;
-            cur_y = y + offset_y;
-
-            // Make sure that we are not going out-of-bounds and are not checking self
-            if( cur_x >= 0 && cur_x < grid_nrows  &&
-                cur_y >= 0 && cur_y < grid_ncols &&
-                !(cur_x == x && cur_y == y))
-                {
-                    indexes.push_back(std::pair<int, int>(cur_x, cur_y));
-                }
-        }
-    }
-    return indexes;
-}
-
-// Obtain number of mines that are adjacent to Cell at given coordinates
-int get_num_adjacent_mines(int x, int y)
-{
-    int total = 0;
-    std::vector<std::pair<int, int> > adjacent_indexes = get_adjacent_indexes(x, y);
-
-    for(std::pair<int, int> index : adjacent_indexes)
-    {
-        if(grid[index.first][index.second].mine)
-        {
-            ++total;
-        }
-    }
-
-    return total;
-}
-
-// Reveals starting Cell, and continues revealing all hint Cells of value 0.
-void reveal_adjacent_safe_cells(int x, int y)
+// Get desired move from user
+std::pair<int, int> get_move()
 {
-    std::deque<std::pair<int, int> > queue{std::pair<int, int>(x, y)};
-    std::vector<std::pair<int, int> > visited;
-
-    auto already_visisted_or_in_queue = [&visited, &queue](std::pair<int, int> index) -> bool {
-
-        for(std::pair<int, int>& v : visited)
-        {
-            if(v == index)
-                return true;
-        }
-        for(std::pair<int, int>& v : queue)
-        {
-            if(v == index)
-                return true;
-        }
-        return false;
-    };
-
-    auto add_adjacent_hint_cells_to_queue = [&queue, &already_visisted_or_in_queue](std::pair<int, int> cell) -> void {
+    std::pair<int, int> move;
+    std::string input;
+    std::istringstream stream;
 
-        std::vector<std::pair<int, int> > adjacent_indexes = get_adjacent_indexes(cell.first, cell.second);
+    std::cin.ignore(1);
 
-        for(std::pair<int, int> index : adjacent_indexes)
-        {
-            if(!grid.at(index.first).at(index.second).mine && !already_visisted_or_in_queue(index))
-            {
-                queue.push_back(index);
-            }
-        }
-    };
+    std::getline(std::cin, input);
+    stream = std::istringstream(input);
+    stream >> move.first >> move.second;
 
-    while(!queue.empty())
-    {
-        std::pair<int, int> index = queue.front();
-        queue.pop_front();
-        visited.push_back(index);
-        grid.at(index.first).at(index.second).hidden = false;
-        --hidden_cells;
-        if(grid.at(index.first).at(index.second).hint == 0)
-            add_adjacent_hint_cells_to_queue(index);
-    }
+    return move;
 }
 
-// Make first move of the game, marking initial cell and generating mines and hints.
-// Ensures that the cell chosen as the initial move of the game is not a mine so that the player can not lose on the first turn.
-void make_first_move(int initial_x, int initial_y)
+// Tell the Solver about every cell that has been revealed since the last call.
+void report_revealed_cells(Game& game, SolverSession& session)
 {
-    int row, col;
-    int cur_mines = 0;
-
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> row_rand(0, grid_nrows - 1);
-    std::uniform_int_distribution<int> col_rand(0, grid_ncols - 1);
-
-    // Randomly assign Cells to contain mines
-    while(cur_mines < max_mines)
+    for(std::pair<int, int>& index : game.take_revealed_cells())
     {
-        row = row_rand(gen);
-        col = col_rand(gen);
-
-        // If the current cell is not already a mine, or was the cell picked for the initial move
-        if( ! grid.at(row).at(col).mine && !(row == initial_x && col == initial_y))
-        {
-            grid.at(row).at(col).mine = true;
-            ++cur_mines;
-        }
+        session.reveal(index.first, index.second, game.hint(index.first, index.second));
     }
-
-    // Assign the value of hint Cells according to the number of mines adjacent to them
-    for(int row = 0; row < grid_nrows; ++row)
-    {
-        for(int col = 0; col < grid_ncols; ++col)
-        {
-            if(!grid.at(row).at(col).mine)
-            {
-                grid.at(row).at(col).hint = get_num_adjacent_mines(row, col);
-            }
-        }
-    }
-
 }
 
-// Generate a new grid of Minesweeper.
-void init_grid(int nrows, int ncols, int num_mines)
+// Play a whole game using only moves from the Solver. Returns true if the game was won.
+bool play_game(Solver& s, Game& game, int nrows, int ncols, int num_mines)
 {
-    max_mines = num_mines;
-    grid_nrows = nrows;
-    grid_ncols = ncols;
+    SolverSession session(s, nrows, ncols, num_mines);
 
-    // Assign each index of the grid a Cell
-    grid = std::vector<std::vector<Cell> >(nrows);
-    for(int row = 0; row < nrows; ++row)
+    while(!game.lost() && !game.won())
     {
-        grid.at(row) = std::vector<Cell>(ncols);
-        for(int col = 0; col < ncols; ++col)
-        {
-            grid.at(row).at(col) = Cell{true, false, 0};
-        }
+        std::pair<int, int> move = session.best_move();
+        game.make_move(move.first, move.second);
+        report_revealed_cells(game, session);
     }
 
-    game_won = false;
-    game_lost = false;
-    first_move = true;
-    hidden_cells = nrows * ncols;
+    return game.won();
 }
 
-// Reveals all Cells
-void reveal_grid()
+// Write the metrics of an automatic run to metrics_path, in the format its extension asks for.
+bool write_metrics(const SolverMetrics& metrics)
 {
-    for(int row = 0; row < grid_nrows; ++row)
-    {
-        for(int col = 0; col < grid_ncols; ++col)
-        {
-            grid.at(row).at(col).hidden = false;
-        }
-    }
-}
+    std::ofstream out(metrics_path);
+    bool csv = metrics_path.size() >= 4 && metrics_path.compare(metrics_path.size() - 4, 4, ".csv") == 0;
 
-void make_move(int x, int y)
-{
-    if(first_move)
-    {
-        first_move = false;
-        make_first_move(x, y);
-        reveal_adjacent_safe_cells(x, y);
-    }
-    else if(grid.at(x).at(y).mine)
+    if(csv)
     {
-        game_lost = true;
-        reveal_grid();
+        metrics.write_csv(out);
     }
     else
     {
-        reveal_adjacent_safe_cells(x, y);
-    }
-
-    if(max_mines >= hidden_cells)
-    {
-        game_won = true;
-        reveal_grid();
+        metrics.write_json(out);
     }
+    return static_cast<bool>(out);
 }
 
-// Get desired move from user
-std::pair<int, int> get_move()
+// Automatically play desired number of games, getting all moves from the Solver. Games are handed out to num_threads workers, each with its own Solver.
+// Every game plays from its own stream of the seed, so which worker plays it doesn't change the result. If a corpus is given, game i is played on board i
+// of the corpus instead of a random one. If metrics were asked for, each worker records its own Solver's calls and they are merged at the end.
+void auto_play(int nrows, int ncols, int num_mines, BoardCorpus* corpus)
 {
-    std::pair<int, int> move;
-    std::string input;
-    std::istringstream stream;
-
-    std::cin.ignore(1);
+    Rng rng(seed);
+    std::atomic<int> next_round(0);
+    std::mutex output_mutex;
+    std::vector<int> worker_wins(num_threads);
+    std::vector<int> worker_losses(num_threads);
+    std::vector<SolverMetrics> worker_metrics(num_threads);
+
+    auto worker = [&](int id) -> void {
+        Solver s;
+        s.set_num_threads(num_solver_threads);
+        if(!metrics_path.empty())
+        {
+            s.set_metrics(&worker_metrics[id]);
+        }
+        int round;
 
-    std::getline(std::cin, input);
-    stream = std::istringstream(input);
-    stream >> move.first >> move.second;
+        while((round = next_round++) < num_rounds)
+        {
+            Rng game_rng = rng.stream(round);
+            Game game = corpus ? Game(nrows, ncols, corpus->layout(round)) : Game(nrows, ncols, num_mines, game_rng.stream(0));
+            s.set_rng(game_rng.stream(1));
 
-    return move;
-}
+            bool won = play_game(s, game, nrows, ncols, num_mines);
 
-void print_grid()
-{
-    for(int row = 0; row < grid_nrows; ++row)
-    {
-        for(int col = 0; col < grid_ncols; ++col)
-        {
-            if(grid.at(row).at(col).hidden)
-            {
-                std::cout << "# ";
-            }
-            else if(grid.at(row).at(col).mine)
+            if(won)
             {
-                std::cout << "M ";
+                worker_wins[id]++;
             }
             else
             {
-                std::cout << hint_character_set[grid.at(row).at(col).hint] << " ";
+                worker_losses[id]++;
             }
-        }
-        std::cout << std::endl;
-    }
-}
 
-// Converts the current game board that consists of Cells into a simpler one consisting of ints for interfacing with the Solver.
-std::vector<std::vector<int> > convert_to_simple_grid()
-{
-    std::vector<std::vector<int> > simple(grid.size(), std::vector<int>(grid[0].size()));
+            std::lock_guard<std::mutex> lock(output_mutex);
+            std::cout << round+1 << " of " << num_rounds << (won ? ": WON\n" : ": LOST\n");
+        }
+    };
 
-    for(size_t row = 0; row < grid.size(); ++row)
+    std::vector<std::thread> threads;
+    for(int id = 1; id < num_threads; ++id)
     {
-        for(size_t col = 0; col < grid[0].size(); ++col)
-        {
-            if(grid.at(row).at(col).hidden)
-            {
-                simple.at(row).at(col) = -1;
-            }
-            else
-            {
-                simple.at(row).at(col) = grid.at(row).at(col).hint;
-            }
-        }
+        threads.emplace_back(worker, id);
+    }
+    worker(0);
+    for(std::thread& thread : threads)
+    {
+        thread.join();
     }
-
-    return simple;
-}
-
-// Automatically play desired number of games, getting all moves from the Solver.
-void auto_play(int width, int height, int num_mines)
-{
-    Solver s;
-    std::pair<int, int> move;
 
     int wins = 0;
     int losses = 0;
-
-    for(int round = 0; round < num_rounds; ++round)
+    SolverMetrics metrics;
+    for(int id = 0; id < num_threads; ++id)
     {
-        init_grid(width, height, num_mines);
-
-        while(1)
-        {
-            move = s.best_move(convert_to_simple_grid(), num_mines);
-            make_move(move.first, move.second);
-
-            if(game_lost)
-            {
-                std::cout << round+1 << " of " << num_rounds << ": LOST\n";
-                losses++;
-                break;
-            }
-            else if(game_won)
-            {
-                std::cout << round+1 << " of " << num_rounds << ": WON\n";
-                wins++;
-                break;
-            }
-            
-        }
+        wins += worker_wins[id];
+        losses += worker_losses[id];
+        metrics.merge(worker_metrics[id]);
     }
 
     std::cout << "Out of " << num_rounds << " rounds: " << wins << " wins, " << losses << " losses.\n";
+
+    if(!metrics_path.empty() && !write_metrics(metrics))
+    {
+        std::cout << "Could not write metrics to " << metrics_path << std::endl;
+    }
 }
 
-// Play a single game manually, allowing user and Solver input.
-void manual_play(int width, int height, int num_mines)
+// Play a single game manually, allowing user and Solver input. The game is the same as the first game of an automatic run with the same seed.
+void manual_play(int nrows, int ncols, int num_mines)
 {
+    Rng game_rng = Rng(seed).stream(0);
     Solver s;
+    s.set_num_threads(num_solver_threads);
+    s.set_rng(game_rng.stream(1));
+    Game game(nrows, ncols, num_mines, game_rng.stream(0));
+    SolverSession session(s, nrows, ncols, num_mines);
     std::pair<int, int> move;
     
 
-    init_grid(width, height, num_mines);
-    print_grid();
+    game.print();
 
-    while(!game_lost && !game_won)
+    while(!game.lost() && !game.won())
     {
         char c;
         std::cin >> c;
@@ -381,20 +198,21 @@ void manual_play(int width, int height, int num_mines)
             move = get_move();
         else
         {
-            move = s.best_move(convert_to_simple_grid(), num_mines);
+            move = session.best_move();
             std::cout << "Move chosen was (" << move.first << ", " << move.second << ")\n";
         }
         
 
-        make_move(move.first, move.second);
-        print_grid();
+        game.make_move(move.first, move.second);
+        report_revealed_cells(game, session);
+        game.print();
     }
 
-    if(game_lost)
+    if(game.lost())
     {
         std::cout << "You lost." << std::endl;
     }
-    else if(game_won)
+    else if(game.won())
     {
         std::cout << "You won." << std::endl;
     }
@@ -403,7 +221,7 @@ void manual_play(int width, int height, int num_mines)
 
 void print_usage_and_exit()
 {
-    std::cout << "Optional args: -[a/A] #NUM_ROUNDS, -[easy/med/hard]" << std::endl;
+    std::cout << "Optional args: -[a/A] #NUM_ROUNDS, -[j/J] #NUM_THREADS, -[t/T] #NUM_SOLVER_THREADS, -[s/S] #SEED, -[easy/med/hard], -[g/G] FILE #NUM_BOARDS, -[c/C] FILE, -[m/M] FILE" << std::endl;
     exit(0);
 }
 
@@ -424,6 +242,59 @@ void parse_args(int argc, char **args)
             }
             num_rounds = std::stoi(cur);
         }
+        else if(cur == "-j" || cur == "-J")
+        {
+            if(++i >= argc || cur.assign(args[i]).find_first_not_of("0123456789") != std::string::npos || std::stoi(cur) < 1)
+            {
+                print_usage_and_exit();
+            }
+            num_threads = std::stoi(cur);
+        }
+        else if(cur == "-t" || cur == "-T")
+        {
+            if(++i >= argc || cur.assign(args[i]).find_first_not_of("0123456789") != std::string::npos || std::stoi(cur) < 1)
+            {
+                print_usage_and_exit();
+            }
+            num_solver_threads = std::stoi(cur);
+        }
+        else if(cur == "-s" || cur == "-S")
+        {
+            if(++i >= argc || cur.assign(args[i]).empty() || cur.find_first_not_of("0123456789") != std::string::npos)
+            {
+                print_usage_and_exit();
+            }
+            seeded = true;
+            seed = std::stoull(cur);
+        }
+        else if(cur == "-g" || cur == "-G")
+        {
+            if(i + 2 >= argc || cur.assign(args[i + 2]).empty() || cur.find_first_not_of("0123456789") != std::string::npos)
+            {
+                print_usage_and_exit();
+            }
+            generate_corpus = true;
+            corpus_path = args[i + 1];
+            corpus_size = std::stoull(cur);
+            i += 2;
+        }
+        else if(cur == "-c" || cur == "-C")
+        {
+            if(++i >= argc)
+            {
+                print_usage_and_exit();
+            }
+            automatic = true;
+            corpus_path = args[i];
+        }
+        else if(cur == "-m" || cur == "-M")
+        {
+            if(++i >= argc)
+            {
+                print_usage_and_exit();
+            }
+            metrics_path = args[i];
+        }
         else if(cur == "-easy")
         {
             difficulty = EASY;
@@ -448,6 +319,11 @@ int main(int argc, char **args)
     int nrows, ncols, num_mines;
     parse_args(argc, args);
 
+    if(!seeded)
+    {
+        seed = Rng::random_seed();
+    }
+
     if(difficulty == EASY)
     {
         nrows = EASY_DIMENSIONS.first;
@@ -467,9 +343,38 @@ int main(int argc, char **args)
         num_mines = HARD_NUM_MINES;
     }
 
-    if(automatic)
+    if(generate_corpus)
+    {
+        if(!write_corpus(corpus_path, nrows, ncols, num_mines, corpus_size, Rng(seed)))
+        {
+            std::cout << "Could not write corpus " << corpus_path << std::endl;
+            return 1;
+        }
+        std::cout << "Seed: " << seed << "\nWrote " << corpus_size << " boards to " << corpus_path << std::endl;
+    }
+    else if(automatic && !corpus_path.empty())
+    {
+        BoardCorpus corpus;
+        if(!corpus.open(corpus_path) || corpus.size() > static_cast<uint64_t>(std::numeric_limits<int>::max()))
+        {
+            std::cout << "Could not read corpus " << corpus_path << std::endl;
+            return 1;
+        }
+        uint64_t bad_board = corpus.check_layouts();
+        if(bad_board != corpus.size())
+        {
+            std::cout << "Board " << bad_board << " of corpus " << corpus_path << " does not have " << corpus.num_mines() << " mines" << std::endl;
+            return 1;
+        }
+        num_rounds = corpus.size();
+
+        std::cout << "Seed: " << seed << "\n";
+        auto_play(corpus.nrows(), corpus.ncols(), corpus.num_mines(), &corpus);
+    }
+    else if(automatic)
     {
-        auto_play(nrows, ncols, num_mines);
+        std::cout << "Seed: " << seed << "\n";
+        auto_play(nrows, ncols, num_mines, nullptr);
     }
     else
     {
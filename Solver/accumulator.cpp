@@ -0,0 +1,82 @@
+#include "accumulator.hpp"
+
+SolutionAccumulator::SolutionAccumulator(int num_cells) : cell_mines(1, std::vector<double>(num_cells))
+{
+    totals = std::vector<double>(1);
+}
+
+SolutionAccumulator::~SolutionAccumulator()
+{
+
+}
+
+// Record one solution that has num_mines mines in it.
+void SolutionAccumulator::add(const std::vector<bool>& assignment, int num_mines)
+{
+    while(static_cast<int>(totals.size()) <= num_mines)
+    {
+        totals.push_back(0.0);
+        cell_mines.push_back(std::vector<double>(assignment.size()));
+    }
+
+    totals[num_mines] += 1;
+    for(size_t cell = 0; cell < assignment.size(); ++cell)
+    {
+        if(assignment[cell])
+        {
+            cell_mines[num_mines][cell] += 1;
+        }
+    }
+}
+
+// Record one solution's worth of weight with num_mines mines, spread over the cells by their estimated probability of being a mine.
+void SolutionAccumulator::add_estimate(const std::vector<double>& probabilities, int num_mines)
+{
+    while(static_cast<int>(totals.size()) <= num_mines)
+    {
+        totals.push_back(0.0);
+        cell_mines.push_back(std::vector<double>(probabilities.size()));
+    }
+
+    totals[num_mines] += 1;
+    for(size_t cell = 0; cell < probabilities.size(); ++cell)
+    {
+        cell_mines[num_mines][cell] += probabilities[cell];
+    }
+}
+
+// Add in the solutions counted by another accumulator over the same cells.
+void SolutionAccumulator::merge(const SolutionAccumulator& other)
+{
+    while(totals.size() < other.totals.size())
+    {
+        totals.push_back(0.0);
+        cell_mines.push_back(std::vector<double>(cell_mines[0].size()));
+    }
+
+    for(size_t k = 0; k < other.totals.size(); ++k)
+    {
+        totals[k] += other.totals[k];
+        for(size_t cell = 0; cell < other.cell_mines[k].size(); ++cell)
+        {
+            cell_mines[k][cell] += other.cell_mines[k][cell];
+        }
+    }
+}
+
+int SolutionAccumulator::num_cells()
+{
+    return cell_mines[0].size();
+}
+
+bool SolutionAccumulator::empty()
+{
+    for(double total : totals)
+    {
+        if(total > 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
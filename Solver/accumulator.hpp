@@ -0,0 +1,26 @@
+/*
+    Running totals over the solutions of one frontier component. Solutions are added as the search finds them and are never stored, so memory only
+    depends on the size of the component and the largest number of mines seen in a solution, not on how many solutions there are.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+class SolutionAccumulator
+{
+    public:
+
+    std::vector<double> totals;                     // totals[k] is the number of solutions with k mines
+    std::vector<std::vector<double> > cell_mines;   // cell_mines[k][cell] is the number of those solutions where cell is a mine
+
+    SolutionAccumulator(int num_cells);
+    ~SolutionAccumulator();
+
+    void add(const std::vector<bool>& assignment, int num_mines);
+    void add_estimate(const std::vector<double>& probabilities, int num_mines);
+    void merge(const SolutionAccumulator& other);
+    int num_cells();
+    bool empty();
+};
@@ -0,0 +1,24 @@
+#include "batch.hpp"
+
+BoardBatch::BoardBatch(int nrows, int ncols, int num_boards) : cells(nrows * ncols * num_boards, -1)
+{
+    this->nrows = nrows;
+    this->ncols = ncols;
+    this->num_boards = num_boards;
+}
+
+BoardBatch::~BoardBatch()
+{
+
+}
+
+void BoardBatch::set_board(int board, const std::vector<std::vector<int> >& grid)
+{
+    for(int row = 0; row < nrows; ++row)
+    {
+        for(int col = 0; col < ncols; ++col)
+        {
+            (*this)(board, row, col) = grid[row][col];
+        }
+    }
+}
@@ -0,0 +1,34 @@
+/*
+    Many boards of the same size, stored structure-of-arrays: the values of one cell on every board are next to each other in memory. A pass over the
+    boards then walks each cell once and handles all of the boards in the inner loop, which the compiler turns into vector code, instead of going board
+    by board.
+
+    Cells use the same values as the boards handed to Solver::best_move: -1 for hidden and 0-8 for a revealed hint.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class BoardBatch
+{
+    private:
+
+    std::vector<int8_t> cells;
+
+    public:
+
+    int nrows;
+    int ncols;
+    int num_boards;
+
+    BoardBatch(int nrows, int ncols, int num_boards);
+    ~BoardBatch();
+
+    // Values of cell (row, col) on every board, one per board.
+    int8_t* lane(int row, int col) { return &cells[(row * ncols + col) * num_boards]; }
+    int8_t& operator()(int board, int row, int col) { return cells[(row * ncols + col) * num_boards + board]; }
+
+    void set_board(int board, const std::vector<std::vector<int> >& grid);
+};
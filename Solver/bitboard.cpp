@@ -0,0 +1,312 @@
+#include "bitboard.hpp"
+
+Bitboard::Bitboard()
+{
+    nrows = 0;
+    ncols = 0;
+    stride = 0;
+}
+
+Bitboard::Bitboard(int nrows, int ncols)
+{
+    this->nrows = nrows;
+    this->ncols = ncols;
+    stride = ncols + 1;
+    words = std::vector<uint64_t>((nrows * stride + 63) / 64);
+}
+
+Bitboard::~Bitboard()
+{
+
+}
+
+// The set of every cell of a board, which is every bit except the spare one at the end of each row.
+Bitboard Bitboard::all_cells(int nrows, int ncols)
+{
+    Bitboard cells(nrows, ncols);
+
+    for(int x = 0; x < nrows; ++x)
+    {
+        for(int y = 0; y < ncols; ++y)
+        {
+            cells.set(x, y);
+        }
+    }
+
+    return cells;
+}
+
+Bitboard& Bitboard::operator&=(const Bitboard& other)
+{
+    for(size_t i = 0; i < words.size(); ++i)
+    {
+        words[i] &= other.words[i];
+    }
+    return *this;
+}
+
+Bitboard& Bitboard::operator|=(const Bitboard& other)
+{
+    for(size_t i = 0; i < words.size(); ++i)
+    {
+        words[i] |= other.words[i];
+    }
+    return *this;
+}
+
+Bitboard& Bitboard::operator^=(const Bitboard& other)
+{
+    for(size_t i = 0; i < words.size(); ++i)
+    {
+        words[i] ^= other.words[i];
+    }
+    return *this;
+}
+
+// The cells in this set that are not in other.
+Bitboard Bitboard::without(const Bitboard& other) const
+{
+    Bitboard result(*this);
+    for(size_t i = 0; i < words.size(); ++i)
+    {
+        result.words[i] &= ~other.words[i];
+    }
+    return result;
+}
+
+// Move every bit up by the given number of positions, or down if it is negative. Bits moved past either end are lost.
+Bitboard Bitboard::shifted(int bits) const
+{
+    Bitboard result(nrows, ncols);
+    int num_words = words.size();
+    int word_shift = (bits < 0 ? -bits : bits) / 64;
+    int bit_shift = (bits < 0 ? -bits : bits) % 64;
+
+    for(int i = 0; i < num_words; ++i)
+    {
+        if(bits >= 0)
+        {
+            int from = i - word_shift;
+            uint64_t low = from >= 0 ? words[from] << bit_shift : 0;
+            uint64_t carry = bit_shift && from - 1 >= 0 ? words[from - 1] >> (64 - bit_shift) : 0;
+            result.words[i] = low | carry;
+        }
+        else
+        {
+            int from = i + word_shift;
+            uint64_t high = from < num_words ? words[from] >> bit_shift : 0;
+            uint64_t carry = bit_shift && from + 1 < num_words ? words[from + 1] << (64 - bit_shift) : 0;
+            result.words[i] = high | carry;
+        }
+    }
+
+    return result;
+}
+
+// Move every cell of the set one step in one of the eight directions, numbered 0-7. Cells that leave the board are dropped. cells is the set of every cell of the board.
+Bitboard Bitboard::step(int direction, const Bitboard& cells) const
+{
+    const int offsets[8] = {1, -1, stride, -stride, stride - 1, 1 - stride, stride + 1, -stride - 1};
+    return shifted(offsets[direction]) &= cells;
+}
+
+// Every cell adjacent to a cell in this set, not counting the set's own cells unless they are adjacent to another. cells is the set of every cell of the board.
+Bitboard Bitboard::neighbors(const Bitboard& cells) const
+{
+    Bitboard result(nrows, ncols);
+
+    for(int direction = 0; direction < 8; ++direction)
+    {
+        result |= step(direction, cells);
+    }
+
+    return result;
+}
+
+int Bitboard::count() const
+{
+    int total = 0;
+    for(uint64_t word : words)
+    {
+        total += __builtin_popcountll(word);
+    }
+    return total;
+}
+
+bool Bitboard::empty() const
+{
+    for(uint64_t word : words)
+    {
+        if(word)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The first cell of the set in row-major order, or (-1, -1) if it is empty.
+std::pair<int, int> Bitboard::first() const
+{
+    for(size_t i = 0; i < words.size(); ++i)
+    {
+        if(words[i])
+        {
+            int bit = i * 64 + __builtin_ctzll(words[i]);
+            return {bit / stride, bit % stride};
+        }
+    }
+    return {-1, -1};
+}
+
+// Every cell of the set, in row-major order.
+std::vector<std::pair<int, int> > Bitboard::positions() const
+{
+    std::vector<std::pair<int, int> > cells;
+
+    for(size_t i = 0; i < words.size(); ++i)
+    {
+        for(uint64_t word = words[i]; word; word &= word - 1)
+        {
+            int bit = i * 64 + __builtin_ctzll(word);
+            cells.push_back({bit / stride, bit % stride});
+        }
+    }
+
+    return cells;
+}
+
+BitCounter::BitCounter(int nrows, int ncols)
+{
+    for(Bitboard& plane : planes)
+    {
+        plane = Bitboard(nrows, ncols);
+    }
+}
+
+BitCounter::~BitCounter()
+{
+
+}
+
+void BitCounter::add(const Bitboard& set)
+{
+    Bitboard carry = set;
+
+    for(Bitboard& plane : planes)
+    {
+        Bitboard next_carry = plane & carry;
+        plane ^= carry;
+        carry = next_carry;
+    }
+}
+
+// Add to every cell the number of its neighbors that are in the set. cells is the set of every cell of the board.
+void BitCounter::add_neighbors(const Bitboard& set, const Bitboard& cells)
+{
+    for(int direction = 0; direction < 8; ++direction)
+    {
+        add(set.step(direction, cells));
+    }
+}
+
+// The cells of the board whose count is exactly value. cells is the set of every cell of the board.
+Bitboard BitCounter::equals(int value, const Bitboard& cells) const
+{
+    Bitboard result = cells;
+
+    for(int i = 0; i < 4; ++i)
+    {
+        result &= (value >> i) & 1 ? planes[i] : cells.without(planes[i]);
+    }
+
+    return result;
+}
+
+BoardBits::BoardBits(Matrix& board) : cells(Bitboard::all_cells(board.height, board.width)), hidden(board.height, board.width),
+                                      revealed(board.height, board.width), mines(board.height, board.width)
+{
+    for(Bitboard& plane : hints)
+    {
+        plane = Bitboard(board.height, board.width);
+    }
+
+    for(int row = 0; row < board.height; ++row)
+    {
+        for(int col = 0; col < board.width; ++col)
+        {
+            int value = board(row, col);
+
+            if(value == -1)
+            {
+                hidden.set(row, col);
+            }
+            else if(value == -2)
+            {
+                mines.set(row, col);
+            }
+            else
+            {
+                revealed.set(row, col);
+                hints[value].set(row, col);
+            }
+        }
+    }
+}
+
+BoardBits::~BoardBits()
+{
+
+}
+
+// Hidden cells with at least one revealed neighbor.
+Bitboard BoardBits::frontier() const
+{
+    return hidden & revealed.neighbors(cells);
+}
+
+// Revealed cells whose hint value is the same as their count.
+Bitboard BoardBits::count_equals_hint(const BitCounter& counter) const
+{
+    Bitboard result(cells.height(), cells.width());
+
+    for(int value = 0; value < 9; ++value)
+    {
+        result |= hints[value] & counter.equals(value, cells);
+    }
+
+    return result;
+}
+
+/*
+    The same deductions as trivial_move, made on the whole board at once on a normalized board. Hints with as many hidden neighbors as their value make
+    all of those neighbors mines. Hints with as many of those new mines around them as their value make the rest of their hidden neighbors safe.
+
+    Returns true and sets move to the first safe cell in row-major order if there is one, and adds the new mines to mines. Returns false, and adds
+    nothing, if no safe cell can be found this way.
+*/
+bool find_trivial_move_bits(BoardBits& bits, std::vector<std::pair<int, int> >& mines, std::pair<int, int>& move)
+{
+    int nrows = bits.cells.height();
+    int ncols = bits.cells.width();
+
+    BitCounter hidden_count(nrows, ncols);
+    hidden_count.add_neighbors(bits.hidden, bits.cells);
+    Bitboard full_hints = bits.count_equals_hint(hidden_count).without(bits.hints[0]);
+    Bitboard new_mines = bits.hidden & full_hints.neighbors(bits.cells);
+
+    BitCounter mine_count(nrows, ncols);
+    mine_count.add_neighbors(new_mines, bits.cells);
+    Bitboard satisfied_hints = bits.count_equals_hint(mine_count);
+    Bitboard safe = bits.hidden.without(new_mines) & satisfied_hints.neighbors(bits.cells);
+
+    if(safe.empty())
+    {
+        return false;
+    }
+
+    std::vector<std::pair<int, int> > found = new_mines.positions();
+    mines.insert(mines.end(), found.begin(), found.end());
+    move = safe.first();
+    return true;
+}
@@ -0,0 +1,97 @@
+/*
+    A set of cells of a board, stored as one bit per cell.
+
+    Bits are laid out row by row, and each row has one spare bit after its last column that is never set. Moving every cell of a set one step in any of
+    the eight directions is then a single shift of the whole bit string: one bit for left and right, a row's worth of bits for up and down. A cell that
+    moves off the left or right edge lands in a spare bit, and is cleared by masking with the set of real cells. On an expert board the whole set is
+    eight 64-bit words, so "every hidden cell next to a revealed cell" is a few dozen word operations.
+
+    BoardBits splits a board into these sets: hidden cells, revealed cells, known mines, and one set per hint value.
+*/
+
+#pragma once
+
+#include "matrix.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class Bitboard
+{
+    private:
+
+    int nrows;
+    int ncols;
+    int stride;     // Bits per row, including the spare bit
+    std::vector<uint64_t> words;
+
+    public:
+
+    Bitboard();
+    Bitboard(int nrows, int ncols);
+    ~Bitboard();
+
+    static Bitboard all_cells(int nrows, int ncols);
+
+    int height() const { return nrows; }
+    int width() const { return ncols; }
+
+    bool get(int x, int y) const { int bit = x * stride + y; return (words[bit / 64] >> (bit % 64)) & 1; }
+    void set(int x, int y) { int bit = x * stride + y; words[bit / 64] |= uint64_t(1) << (bit % 64); }
+
+    Bitboard& operator&=(const Bitboard& other);
+    Bitboard& operator|=(const Bitboard& other);
+    Bitboard& operator^=(const Bitboard& other);
+    Bitboard operator&(const Bitboard& other) const { Bitboard result(*this); return result &= other; }
+    Bitboard operator|(const Bitboard& other) const { Bitboard result(*this); return result |= other; }
+    Bitboard operator^(const Bitboard& other) const { Bitboard result(*this); return result ^= other; }
+    Bitboard without(const Bitboard& other) const;
+
+    Bitboard shifted(int bits) const;
+    Bitboard step(int direction, const Bitboard& cells) const;
+    Bitboard neighbors(const Bitboard& cells) const;
+
+    int count() const;
+    bool empty() const;
+    std::pair<int, int> first() const;
+    std::vector<std::pair<int, int> > positions() const;
+};
+
+/*
+    Running count, per cell, of how many of the sets added to it contain that cell. The count is kept bit-sliced: bit i of every cell's count is in
+    plane i, so adding a set is a ripple-carry add done on whole words at once. Counts go up to 15, enough for the eight neighbors of a cell.
+*/
+class BitCounter
+{
+    private:
+
+    Bitboard planes[4];
+
+    public:
+
+    BitCounter(int nrows, int ncols);
+    ~BitCounter();
+
+    void add(const Bitboard& set);
+    void add_neighbors(const Bitboard& set, const Bitboard& cells);
+    Bitboard equals(int value, const Bitboard& cells) const;
+};
+
+struct BoardBits
+{
+    Bitboard cells;     // Every cell of the board
+    Bitboard hidden;
+    Bitboard revealed;
+    Bitboard mines;
+    Bitboard hints[9];  // hints[v] holds the revealed cells with a value of v
+
+    BoardBits(Matrix& board);
+    ~BoardBits();
+
+    Bitboard frontier() const;
+    Bitboard count_equals_hint(const BitCounter& counter) const;
+};
+
+bool find_trivial_move_bits(BoardBits& bits, std::vector<std::pair<int, int> >& mines, std::pair<int, int>& move);
@@ -0,0 +1,221 @@
+#include "component_cache.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+// Combine a color with another value. Colors only decide the order of the cells, so a collision just makes the key less likely to match.
+static uint64_t mix(uint64_t color, uint64_t value)
+{
+    uint64_t z = color ^ (value + 0x9e3779b97f4a7c15ULL + (color << 6) + (color >> 2));
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+size_t ComponentCache::KeyHash::operator()(const std::vector<int>& key) const
+{
+    uint64_t hash = key.size();
+    for(int value : key)
+    {
+        hash = mix(hash, value);
+    }
+    return hash;
+}
+
+ComponentCache::ComponentCache(size_t capacity) : capacity(capacity)
+{
+
+}
+
+ComponentCache::~ComponentCache()
+{
+
+}
+
+// The cache used by every Solver unless it is given another one.
+ComponentCache& ComponentCache::shared()
+{
+    static ComponentCache cache(4096);
+    return cache;
+}
+
+CanonicalComponent ComponentCache::canonicalize(Matrix& normalized_board, FrontierComponent& component)
+{
+    int num_cells = component.fmap.size();
+    int num_hints = component.hints.size();
+
+    std::vector<std::vector<int> > cell_hints(num_cells);
+    std::vector<std::vector<int> > hint_cells(num_hints);
+    std::vector<int> hint_values(num_hints);
+
+    for(int hint = 0; hint < num_hints; ++hint)
+    {
+        std::pair<int, int> pos = component.hints[hint];
+
+        for(const std::pair<int, int>& index : normalized_board.get_adjacent_indices(pos.first, pos.second))
+        {
+            if(component.fmap.count(index))
+            {
+                int cell = component.fmap(index);
+                hint_cells[hint].push_back(cell);
+                cell_hints[cell].push_back(hint);
+            }
+        }
+        hint_values[hint] = normalized_board(pos.first, pos.second);
+    }
+
+    std::vector<uint64_t> cell_colors(num_cells);
+    std::vector<uint64_t> hint_colors(num_hints);
+    std::vector<uint64_t> neighbor_colors;
+
+    for(int cell = 0; cell < num_cells; ++cell)
+    {
+        cell_colors[cell] = cell_hints[cell].size();
+    }
+    for(int round = 0; round < REFINE_ROUNDS; ++round)
+    {
+        for(int hint = 0; hint < num_hints; ++hint)
+        {
+            neighbor_colors.clear();
+            for(int cell : hint_cells[hint])
+            {
+                neighbor_colors.push_back(cell_colors[cell]);
+            }
+            std::sort(neighbor_colors.begin(), neighbor_colors.end());
+
+            hint_colors[hint] = mix(hint_values[hint], hint_cells[hint].size());
+            for(uint64_t color : neighbor_colors)
+            {
+                hint_colors[hint] = mix(hint_colors[hint], color);
+            }
+        }
+
+        for(int cell = 0; cell < num_cells; ++cell)
+        {
+            neighbor_colors.clear();
+            for(int hint : cell_hints[cell])
+            {
+                neighbor_colors.push_back(hint_colors[hint]);
+            }
+            std::sort(neighbor_colors.begin(), neighbor_colors.end());
+
+            for(uint64_t color : neighbor_colors)
+            {
+                cell_colors[cell] = mix(cell_colors[cell], color);
+            }
+        }
+    }
+
+    // Ties are broken by position on the board rather than by index, so the order the component lists its cells in can't change the key
+    std::vector<std::pair<int, int> > positions(num_cells);
+    for(int cell = 0; cell < num_cells; ++cell)
+    {
+        positions[cell] = component.fmap(cell);
+    }
+
+    std::vector<int> order(num_cells);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&cell_colors, &positions](int a, int b) -> bool {
+        return cell_colors[a] != cell_colors[b] ? cell_colors[a] < cell_colors[b] : positions[a] < positions[b];
+    });
+
+    CanonicalComponent canonical;
+    canonical.canonical_cell = std::vector<int>(num_cells);
+    for(int i = 0; i < num_cells; ++i)
+    {
+        canonical.canonical_cell[order[i]] = i;
+    }
+
+    // Each hint as its value followed by its canonical cells, so that sorting them puts the hints in canonical order too
+    std::vector<std::vector<int> > hints(num_hints);
+    for(int hint = 0; hint < num_hints; ++hint)
+    {
+        hints[hint].push_back(hint_values[hint]);
+        for(int cell : hint_cells[hint])
+        {
+            hints[hint].push_back(canonical.canonical_cell[cell]);
+        }
+        std::sort(hints[hint].begin() + 1, hints[hint].end());
+    }
+    std::sort(hints.begin(), hints.end());
+
+    canonical.key.push_back(num_cells);
+    canonical.key.push_back(num_hints);
+    for(const std::vector<int>& hint : hints)
+    {
+        canonical.key.push_back(hint.size() - 1);
+        canonical.key.insert(canonical.key.end(), hint.begin(), hint.end());
+    }
+
+    return canonical;
+}
+
+// Fill solutions with the cached solution counts of a component, if there are any. solutions must be empty.
+bool ComponentCache::lookup(const CanonicalComponent& canonical, SolutionAccumulator& solutions)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = index.find(canonical.key);
+    if(it == index.end())
+    {
+        return false;
+    }
+    entries.splice(entries.begin(), entries, it->second);
+
+    const Entry& entry = *it->second;
+    solutions.totals = entry.totals;
+    solutions.cell_mines = std::vector<std::vector<double> >(entry.totals.size(), std::vector<double>(canonical.canonical_cell.size()));
+    for(size_t k = 0; k < entry.totals.size(); ++k)
+    {
+        for(size_t cell = 0; cell < canonical.canonical_cell.size(); ++cell)
+        {
+            solutions.cell_mines[k][cell] = entry.cell_mines[k][canonical.canonical_cell[cell]];
+        }
+    }
+    return true;
+}
+
+// Remember the solution counts of a component. They must be exact, since they will be handed out in place of a search.
+void ComponentCache::insert(const CanonicalComponent& canonical, const SolutionAccumulator& solutions)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if(capacity == 0 || index.count(canonical.key))
+    {
+        return;
+    }
+
+    Entry entry;
+    entry.key = canonical.key;
+    entry.totals = solutions.totals;
+    entry.cell_mines = std::vector<std::vector<double> >(solutions.totals.size(), std::vector<double>(canonical.canonical_cell.size()));
+    for(size_t k = 0; k < solutions.totals.size(); ++k)
+    {
+        for(size_t cell = 0; cell < canonical.canonical_cell.size(); ++cell)
+        {
+            entry.cell_mines[k][canonical.canonical_cell[cell]] = solutions.cell_mines[k][cell];
+        }
+    }
+
+    if(entries.size() == capacity)
+    {
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+    entries.push_front(std::move(entry));
+    index[entries.front().key] = entries.begin();
+}
+
+size_t ComponentCache::size()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+void ComponentCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+}
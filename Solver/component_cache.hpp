@@ -0,0 +1,71 @@
+/*
+    A cache of the solution counts of frontier components that have already been searched, keyed by the shape of the component rather than where it is.
+
+    A component is put in canonical form by relabeling its cells. Cells are first told apart by color refinement: a cell starts out colored by how many
+    hints it touches, and each round recolors every hint by its value and the colors of its cells, then every cell by its color and the colors of its hints.
+    Cells are then numbered in order of color, with ties broken by their position on the board, so neither the order the component lists its cells and
+    hints in nor where it sits on the board changes the key. The key is the list of hints, each as its value and the new numbers of its cells, sorted.
+    Since ConstraintSearch counts solutions from nothing but the hints' values and cells, two components with the same key have the same solutions once
+    their cells are matched up by number, so a cached entry can be handed to any of them. Ties broken by board order mean a pattern and its mirror image
+    can get different keys, which only costs a cache miss.
+
+    Entries hold the totals of a SolutionAccumulator with the cells in canonical order. The cache holds a fixed number of entries and drops the least
+    recently used one to make room. It locks on every call, so one cache can be shared by Solvers on any number of threads.
+*/
+
+#pragma once
+
+#include "accumulator.hpp"
+#include "frontier.hpp"
+#include "matrix.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// A component in canonical form. canonical_cell[cell] is the number the cell was given.
+struct CanonicalComponent
+{
+    std::vector<int> key;
+    std::vector<int> canonical_cell;
+};
+
+class ComponentCache
+{
+    private:
+
+    static const int REFINE_ROUNDS = 4;     // Rounds of color refinement. Frontier components are thin, so colors rarely change after a few.
+
+    struct Entry
+    {
+        std::vector<int> key;
+        std::vector<double> totals;
+        std::vector<std::vector<double> > cell_mines;   // Indexed by canonical cell
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const std::vector<int>& key) const;
+    };
+
+    size_t capacity;
+    std::list<Entry> entries;               // Most recently used first
+    std::unordered_map<std::vector<int>, std::list<Entry>::iterator, KeyHash> index;
+    std::mutex mutex;
+
+    public:
+
+    ComponentCache(size_t capacity);
+    ~ComponentCache();
+
+    static ComponentCache& shared();
+    static CanonicalComponent canonicalize(Matrix& normalized_board, FrontierComponent& component);
+
+    bool lookup(const CanonicalComponent& canonical, SolutionAccumulator& solutions);
+    void insert(const CanonicalComponent& canonical, const SolutionAccumulator& solutions);
+    size_t size();
+    void clear();
+};
@@ -12,36 +12,19 @@ FrontierMap::FrontierMap(const FrontierMap& other)
     _count = other._count;
 }
 
-FrontierMap::FrontierMap(Matrix& board)
+FrontierMap::FrontierMap(Matrix& board) : FrontierMap(BoardBits(board).frontier())
 {
-    auto is_frontier_cell = [&board](int x, int y) -> bool {
-        // If the cell is "unknown"
-        if(board(x, y) == -1)
-        {
-            std::vector<std::pair<int, int> > neighbors = board.get_adjacent_indices(x, y);
-            for(std::pair<int, int> neightbor : neighbors)
-            {
-                if(board(neightbor.first, neightbor.second) >= 0)
-                {
-                    return true;
-                }
-            }
-        }
-        return false;
-    };
 
+}
 
+// Number the cells of the frontier in row-major order.
+FrontierMap::FrontierMap(const Bitboard& frontier)
+{
     _count = 0;
-    
-    for(int row = 0; row < board.height; ++row)
+
+    for(const std::pair<int, int>& cell : frontier.positions())
     {
-        for(int col = 0; col < board.width; ++col)
-        {
-            if(is_frontier_cell(row, col))
-            {
-                add(row, col);
-            }
-        }
+        add(cell.first, cell.second);
     }
 }
 
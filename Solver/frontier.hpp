@@ -4,10 +4,12 @@
 
 #pragma once
 
+#include "bitboard.hpp"
 #include "matrix.hpp"
 
 #include <map>
 #include <utility>
+#include <vector>
 
 class FrontierMap
 {
@@ -23,6 +25,7 @@ class FrontierMap
     FrontierMap();
     FrontierMap(const FrontierMap& other);
     FrontierMap(Matrix& board);
+    FrontierMap(const Bitboard& frontier);
     ~FrontierMap();
 
     void add(int x, int y);
@@ -32,4 +35,14 @@ class FrontierMap
 
     int operator()(const std::pair<int, int>& coord);
     std::pair<int, int> operator()(const int& col);
-};
\ No newline at end of file
+};
+
+/*
+    A connected piece of the frontier. Two frontier cells belong to the same component when they are linked through hint cells they are both adjacent to,
+    so the mines in one component never affect which placements are valid in another.
+*/
+struct FrontierComponent
+{
+    FrontierMap fmap;
+    std::vector<std::pair<int, int> > hints;
+};
@@ -0,0 +1,53 @@
+#include "geometry.hpp"
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+BoardGeometry::BoardGeometry(int nrows, int ncols) : offsets(nrows * ncols + 1)
+{
+    this->nrows = nrows;
+    this->ncols = ncols;
+
+    for(int x = 0; x < nrows; ++x)
+    {
+        for(int y = 0; y < ncols; ++y)
+        {
+            for(int offset_x = -1; offset_x < 2; ++offset_x)
+            {
+                for(int offset_y = -1; offset_y < 2; ++offset_y)
+                {
+                    int cur_x = x + offset_x;
+                    int cur_y = y + offset_y;
+
+                    // Make sure that we are not going out-of-bounds and are not checking self
+                    if(cur_x >= 0 && cur_x < nrows && cur_y >= 0 && cur_y < ncols && !(cur_x == x && cur_y == y))
+                    {
+                        neighbors.push_back({cur_x, cur_y});
+                    }
+                }
+            }
+            offsets[x * ncols + y + 1] = neighbors.size();
+        }
+    }
+}
+
+BoardGeometry::~BoardGeometry()
+{
+
+}
+
+// The shared tables for boards of this size, built on first use.
+const BoardGeometry& BoardGeometry::get(int nrows, int ncols)
+{
+    static std::mutex mutex;
+    static std::map<std::pair<int, int>, std::unique_ptr<BoardGeometry> > geometries;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<BoardGeometry>& geometry = geometries[{nrows, ncols}];
+    if(!geometry)
+    {
+        geometry.reset(new BoardGeometry(nrows, ncols));
+    }
+    return *geometry;
+}
@@ -0,0 +1,49 @@
+/*
+    Neighbor lists for every cell of a board of a given size, worked out once and shared.
+
+    The lists are stored CSR-style: the neighbors of every cell are laid out one after another in a single array, and cell row * ncols + col owns the
+    entries from offsets[cell] up to offsets[cell + 1]. Looking up a cell's neighbors just returns a pair of pointers into that array, so iterating over
+    them never allocates.
+
+    Tables are built the first time a board size is asked for and kept for the life of the program. Lookups are safe from any thread.
+*/
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+// The neighbors of one cell, as (row, col) pairs. Valid for as long as the program runs.
+struct NeighborRange
+{
+    const std::pair<int, int>* first;
+    const std::pair<int, int>* last;
+
+    const std::pair<int, int>* begin() const { return first; }
+    const std::pair<int, int>* end() const { return last; }
+    int size() const { return last - first; }
+};
+
+class BoardGeometry
+{
+    private:
+
+    int nrows;
+    int ncols;
+    std::vector<int> offsets;
+    std::vector<std::pair<int, int> > neighbors;
+
+    BoardGeometry(int nrows, int ncols);
+
+    public:
+
+    ~BoardGeometry();
+
+    static const BoardGeometry& get(int nrows, int ncols);
+
+    NeighborRange adjacent(int x, int y) const
+    {
+        int cell = x * ncols + y;
+        return NeighborRange{neighbors.data() + offsets[cell], neighbors.data() + offsets[cell + 1]};
+    }
+};
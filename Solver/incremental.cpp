@@ -0,0 +1,411 @@
+#include "incremental.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+
+IncrementalSystem::IncrementalSystem(int nrows, int ncols) : ncols(ncols), col_rows(nrows * ncols), pivot_row(nrows * ncols, -1)
+{
+    num_rows = 0;
+    num_cols = 0;
+    overflow = false;
+}
+
+IncrementalSystem::~IncrementalSystem()
+{
+
+}
+
+int IncrementalSystem::coefficient(int row, int col)
+{
+    const std::vector<Entry>& entries = rows[row].entries;
+    auto it = std::lower_bound(entries.begin(), entries.end(), col, [](const Entry& entry, int c) -> bool {
+        return entry.col < c;
+    });
+    return it != entries.end() && it->col == col ? it->value : 0;
+}
+
+void IncrementalSystem::link(int col, int row)
+{
+    if(col_rows[col].empty())
+    {
+        ++num_cols;
+    }
+    col_rows[col].push_back(row);
+}
+
+void IncrementalSystem::unlink(int col, int row)
+{
+    std::vector<int>& list = col_rows[col];
+    auto it = std::find(list.begin(), list.end(), row);
+    if(it != list.end())
+    {
+        *it = list.back();
+        list.pop_back();
+
+        if(list.empty())
+        {
+            --num_cols;
+        }
+    }
+}
+
+void IncrementalSystem::enqueue(int row)
+{
+    if(!queued[row])
+    {
+        queued[row] = true;
+        queue.push_back(row);
+    }
+}
+
+void IncrementalSystem::drop_row(int row)
+{
+    for(const Entry& entry : rows[row].entries)
+    {
+        unlink(entry.col, row);
+    }
+    if(rows[row].pivot != -1)
+    {
+        pivot_row[rows[row].pivot] = -1;
+    }
+
+    rows[row].entries.clear();
+    rows[row].pivot = -1;
+    rows[row].alive = false;
+    free_rows.push_back(row);
+    --num_rows;
+}
+
+/*
+    Clear col from row with pivot, as row = a * row - b * pivot where a and b are their coefficients in col, and keep the column lists in step.
+
+    As in SparseSystem::clear_column, the new row is worked out in 64 bits and divided by its gcd before it is stored. If it still has an entry bigger
+    than SparseSystem::MAX_ENTRY, overflow is set and the row is left as it was.
+*/
+void IncrementalSystem::combine(int row, int pivot, int col)
+{
+    long long a = coefficient(pivot, col);
+    long long b = coefficient(row, col);
+    const std::vector<Entry>& r = rows[row].entries;
+    const std::vector<Entry>& p = rows[pivot].entries;
+
+    wide.clear();
+    auto i = r.begin();
+    auto k = p.begin();
+    while(i != r.end() || k != p.end())
+    {
+        long long entry;
+        int c;
+
+        if(k == p.end() || (i != r.end() && i->col < k->col))
+        {
+            c = i->col;
+            entry = a * (i++)->value;
+        }
+        else if(i == r.end() || k->col < i->col)
+        {
+            c = k->col;
+            entry = -b * (k++)->value;
+            link(c, row);       // Fill-in
+        }
+        else
+        {
+            c = i->col;
+            entry = a * (i++)->value - b * (k++)->value;
+            if(entry == 0)
+            {
+                unlink(c, row);
+            }
+        }
+
+        if(entry != 0)
+        {
+            wide.push_back({c, entry});
+        }
+    }
+
+    long long value = a * rows[row].value - b * rows[pivot].value;
+    long long divisor = std::abs(value);
+    for(auto entry = wide.begin(); entry != wide.end() && divisor != 1; ++entry)
+    {
+        divisor = std::gcd(divisor, std::abs(entry->value));
+    }
+    divisor = std::max(divisor, 1LL);
+
+    if(std::abs(value / divisor) > SparseSystem::MAX_ENTRY)
+    {
+        overflow = true;
+        return;
+    }
+    scratch.clear();
+    for(const WideEntry& entry : wide)
+    {
+        if(std::abs(entry.value / divisor) > SparseSystem::MAX_ENTRY)
+        {
+            overflow = true;
+            return;
+        }
+        scratch.push_back({entry.col, static_cast<int>(entry.value / divisor)});
+    }
+
+    rows[row].entries.assign(scratch.begin(), scratch.end());
+    rows[row].value = value / divisor;
+    normalize(row);
+    enqueue(row);
+}
+
+// Make one of the row's columns its pivot, and clear that column from every other row. The row must already be reduced by every other pivot.
+void IncrementalSystem::choose_pivot(int row)
+{
+    // A coefficient of 1 or -1 keeps the other rows from being scaled, and a column in few rows means few rows to clear
+    int col = -1;
+    std::pair<bool, int> best;
+    for(const Entry& entry : rows[row].entries)
+    {
+        std::pair<bool, int> rank(std::abs(entry.value) != 1, col_rows[entry.col].size());
+        if(col == -1 || rank < best)
+        {
+            col = entry.col;
+            best = rank;
+        }
+    }
+
+    rows[row].pivot = col;
+    pivot_row[col] = row;
+    normalize(row);
+    enqueue(row);
+
+    // Clearing col unlinks it from each row, so go through a copy of its list
+    std::vector<int> others = col_rows[col];
+    for(int other : others)
+    {
+        if(other != row && !overflow)
+        {
+            combine(other, row, col);
+        }
+    }
+}
+
+// Divide a row by the gcd of its entries and its value, and make its pivot coefficient positive, or its first one if it has no pivot.
+void IncrementalSystem::normalize(int row)
+{
+    std::vector<Entry>& entries = rows[row].entries;
+    if(entries.empty())
+    {
+        return;
+    }
+
+    int divisor = 0;
+    for(auto entry = entries.begin(); entry != entries.end() && divisor != 1; ++entry)
+    {
+        divisor = std::gcd(divisor, std::abs(entry->value));
+    }
+    if(divisor != 1)
+    {
+        divisor = std::gcd(divisor, std::abs(rows[row].value));
+    }
+
+    int lead = rows[row].pivot == -1 ? entries[0].value : coefficient(row, rows[row].pivot);
+    if(lead < 0)
+    {
+        divisor = -divisor;
+    }
+    if(divisor == 1)
+    {
+        return;
+    }
+
+    for(Entry& entry : entries)
+    {
+        entry.value /= divisor;
+    }
+    rows[row].value /= divisor;
+}
+
+// Add the row for a hint with value mines among the given hidden cells.
+void IncrementalSystem::add_row(const std::vector<std::pair<int, int> >& cells, int value)
+{
+    if(overflow)
+    {
+        return;
+    }
+
+    int row;
+    if(free_rows.empty())
+    {
+        row = rows.size();
+        rows.push_back(Row());
+        queued.push_back(false);
+    }
+    else
+    {
+        row = free_rows.back();
+        free_rows.pop_back();
+    }
+
+    rows[row].entries.clear();
+    for(const std::pair<int, int>& cell : cells)
+    {
+        rows[row].entries.push_back({cell.first * ncols + cell.second, 1});
+    }
+    std::sort(rows[row].entries.begin(), rows[row].entries.end(), [](const Entry& a, const Entry& b) -> bool {
+        return a.col < b.col;
+    });
+    rows[row].value = value;
+    rows[row].pivot = -1;
+    rows[row].alive = true;
+    ++num_rows;
+
+    for(const Entry& entry : rows[row].entries)
+    {
+        link(entry.col, row);
+    }
+
+    // A pivot row has no other pivot columns in it, so each of these takes one pivot column out of the new row without bringing another in
+    while(true)
+    {
+        int col = -1;
+        for(const Entry& entry : rows[row].entries)
+        {
+            if(pivot_row[entry.col] != -1)
+            {
+                col = entry.col;
+                break;
+            }
+        }
+        if(col == -1)
+        {
+            break;
+        }
+        combine(row, pivot_row[col], col);
+        if(overflow)
+        {
+            return;
+        }
+    }
+
+    // Nothing left means the hint followed from the others
+    if(rows[row].entries.empty())
+    {
+        drop_row(row);
+        return;
+    }
+    choose_pivot(row);
+}
+
+// The cell at (x, y) is safe if value is 0 or a mine if it is 1. Take its column out of the system.
+void IncrementalSystem::resolve(int x, int y, int value)
+{
+    int col = x * ncols + y;
+    if(overflow || col_rows[col].empty())
+    {
+        return;
+    }
+
+    std::vector<int> affected = col_rows[col];
+    int repivot = -1;
+    for(int row : affected)
+    {
+        std::vector<Entry>& entries = rows[row].entries;
+        auto it = std::lower_bound(entries.begin(), entries.end(), col, [](const Entry& entry, int c) -> bool {
+            return entry.col < c;
+        });
+        long long rest = rows[row].value - static_cast<long long>(it->value) * value;
+        overflow = overflow || std::abs(rest) > SparseSystem::MAX_ENTRY;
+        rows[row].value = rest;
+        entries.erase(it);
+
+        if(rows[row].pivot == col)
+        {
+            rows[row].pivot = -1;
+            repivot = row;
+        }
+    }
+    col_rows[col].clear();
+    pivot_row[col] = -1;
+    --num_cols;
+
+    for(int row : affected)
+    {
+        // A row with nothing left was a hint that is now satisfied
+        if(rows[row].entries.empty())
+        {
+            drop_row(row);
+        }
+        else
+        {
+            normalize(row);
+            enqueue(row);
+        }
+    }
+
+    if(repivot != -1 && rows[repivot].alive && !overflow)
+    {
+        choose_pivot(repivot);
+    }
+}
+
+/*
+    Look through the rows that changed since the last call for cells that are certainly safe or mines. A row with only positive coefficients and a value
+    of 0 has no mines in it, and one whose value is the sum of its coefficients has a mine in every cell. A cell whose value is known is the special case
+    of a row with one entry. Mines are added to mines, and the first safe cell found is the move. Rows that gave something away stay queued, since they
+    only go away once the game reveals or the Solver marks their cells.
+*/
+bool IncrementalSystem::find_move(std::vector<std::pair<int, int> >& mines, std::pair<int, int>& move)
+{
+    if(overflow)
+    {
+        return false;
+    }
+
+    bool found = false;
+    size_t kept = 0;
+
+    for(size_t i = 0; i < queue.size(); ++i)
+    {
+        int row = queue[i];
+        queued[row] = false;
+        if(!rows[row].alive)
+        {
+            continue;
+        }
+
+        bool all_positive = true;
+        long long total = 0;
+        for(const Entry& entry : rows[row].entries)
+        {
+            all_positive = all_positive && entry.value > 0;
+            total += entry.value;
+        }
+
+        bool fact = false;
+        if(all_positive && rows[row].value == 0)
+        {
+            if(!found)
+            {
+                int col = rows[row].entries[0].col;
+                move = {col / ncols, col % ncols};
+                found = true;
+            }
+            fact = true;
+        }
+        else if(all_positive && rows[row].value == total)
+        {
+            for(const Entry& entry : rows[row].entries)
+            {
+                mines.push_back({entry.col / ncols, entry.col % ncols});
+            }
+            fact = true;
+        }
+
+        if(fact)
+        {
+            queued[row] = true;
+            queue[kept++] = row;
+        }
+    }
+    queue.resize(kept);
+
+    return found;
+}
@@ -0,0 +1,88 @@
+/*
+    The logic matrix of a game in progress, kept in reduced row echelon form from one move to the next.
+
+    A reveal only adds one hint and takes one cell off the frontier, yet building the logic matrix and eliminating it again every move redoes the work
+    for every hint on the frontier. An IncrementalSystem instead takes each change as it happens:
+
+        add_row     A new hint. Its entries are reduced by the rows that already have a pivot in one of its columns, and if anything is left, one of its
+                    columns becomes a new pivot and is cleared from the other rows.
+        resolve     A cell is now known to be safe or a mine. Its column is substituted out of every row that has it. A row that loses its pivot picks
+                    another, and a row that loses every entry was a hint that is now satisfied, so it is dropped.
+
+    Columns are board cells, numbered row * width + col, so they stay put as the frontier changes. Rows are combined without fractions as in
+    SparseSystem, and each is kept divided by its gcd with its pivot coefficient positive. Every pivot column appears in just one row, so a cell whose
+    value follows from the hints always ends up alone in a row, whatever order the changes came in.
+
+    Coefficients are kept to SparseSystem::MAX_ENTRY as well. A change that would take one past it sets overflow instead, and from then on the system
+    ignores further changes and finds nothing, so the caller should build the logic matrix anew each move.
+
+    Each row that changes is queued, and find_move only looks at the queued rows, so the logic tier costs time in proportion to what changed since the
+    last move rather than to the size of the frontier.
+*/
+
+#pragma once
+
+#include "sparse.hpp"
+
+#include <utility>
+#include <vector>
+
+class IncrementalSystem
+{
+    public:
+
+    typedef SparseSystem::Entry Entry;
+
+    private:
+
+    struct Row
+    {
+        std::vector<Entry> entries;     // Sorted by column
+        int value;
+        int pivot;                      // Column this row is the pivot of, or -1 while it has none
+        bool alive;
+    };
+
+    struct WideEntry
+    {
+        int col;
+        long long value;
+    };
+
+    int ncols;
+    int num_rows;
+    int num_cols;
+    std::vector<Row> rows;
+    std::vector<int> free_rows;
+
+    std::vector<std::vector<int> > col_rows;    // Rows with an entry in each column
+    std::vector<int> pivot_row;                 // Row each column is the pivot of, or -1
+
+    std::vector<int> queue;                     // Rows changed since find_move last looked at them
+    std::vector<bool> queued;
+    std::vector<Entry> scratch;
+    std::vector<WideEntry> wide;                // A combined row before it is divided by its gcd
+    bool overflow;                              // A coefficient would have passed SparseSystem::MAX_ENTRY, and the rows can't be trusted
+
+    int coefficient(int row, int col);
+    void link(int col, int row);
+    void unlink(int col, int row);
+    void enqueue(int row);
+    void drop_row(int row);
+    void combine(int row, int pivot, int col);
+    void choose_pivot(int row);
+    void normalize(int row);
+
+    public:
+
+    IncrementalSystem(int nrows, int ncols);
+    ~IncrementalSystem();
+
+    void add_row(const std::vector<std::pair<int, int> >& cells, int value);
+    void resolve(int x, int y, int value);
+    bool find_move(std::vector<std::pair<int, int> >& mines, std::pair<int, int>& move);
+
+    bool overflowed() const { return overflow; }
+    int height() const { return num_rows; }
+    int width() const { return num_cols; }
+};
@@ -0,0 +1,41 @@
+#include "kernels.hpp"
+
+template<class BoardType>
+static bool find_trivial_move_on(Matrix& matrix, const std::vector<std::pair<int, int> >& hints, std::vector<std::pair<int, int> >& mines, std::pair<int, int>& move)
+{
+    BoardType board(matrix);
+    std::vector<int> mine_cells;
+    int move_cell;
+
+    if(!trivial_move(board, hints, mine_cells, move_cell))
+    {
+        return false;
+    }
+
+    for(int cell : mine_cells)
+    {
+        mines.push_back({cell / matrix.width, cell % matrix.width});
+    }
+    move = {move_cell / matrix.width, move_cell % matrix.width};
+    return true;
+}
+
+// Run the trivial deductions on a normalized board, using the compile-time kernels for the standard easy, medium and hard sizes and bitboards otherwise.
+bool find_trivial_move(Matrix& board, const std::vector<std::pair<int, int> >& hints, std::vector<std::pair<int, int> >& mines, std::pair<int, int>& move)
+{
+    if(board.height == 8 && board.width == 8)
+    {
+        return find_trivial_move_on<Board<8, 8> >(board, hints, mines, move);
+    }
+    if(board.height == 16 && board.width == 16)
+    {
+        return find_trivial_move_on<Board<16, 16> >(board, hints, mines, move);
+    }
+    if(board.height == 16 && board.width == 30)
+    {
+        return find_trivial_move_on<Board<16, 30> >(board, hints, mines, move);
+    }
+
+    BoardBits bits(board);
+    return find_trivial_move_bits(bits, mines, move);
+}
@@ -0,0 +1,171 @@
+/*
+    Board kernels specialized at compile time for the standard board sizes.
+
+    Board<R, C> keeps a whole board in a fixed-size array of bytes, and its neighbor table is a constexpr array built by the compiler, so neighbor loops
+    have known bounds and the board of an expert game fits in a few cache lines.
+
+    find_trivial_move uses these kernels for the standard sizes, and the bitboard version of the same deductions for boards of any other size.
+
+    Only the trivial deductions are specialized. They are the one board-sized kernel that runs on nearly every call. The pattern, propagation and logic
+    tiers work on hints and frontier cells rather than on the whole board, and the other passes over the board, normalize_board and
+    find_move_from_normalized_board, take about a microsecond between them on an expert board. That is too little for a fixed size to pay for another
+    copy of the board.
+*/
+
+#pragma once
+
+#include "bitboard.hpp"
+#include "matrix.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Neighbors of one cell, as cell numbers row * ncols + col.
+struct CellNeighbors
+{
+    const int* first;
+    const int* last;
+
+    const int* begin() const { return first; }
+    const int* end() const { return last; }
+};
+
+template<int R, int C>
+struct NeighborTable
+{
+    std::array<std::array<int, 8>, R * C> index;
+    std::array<int8_t, R * C> count;
+};
+
+template<int R, int C>
+constexpr NeighborTable<R, C> make_neighbor_table()
+{
+    NeighborTable<R, C> table{};
+
+    for(int x = 0; x < R; ++x)
+    {
+        for(int y = 0; y < C; ++y)
+        {
+            int cell = x * C + y;
+            for(int offset_x = -1; offset_x < 2; ++offset_x)
+            {
+                for(int offset_y = -1; offset_y < 2; ++offset_y)
+                {
+                    int cur_x = x + offset_x;
+                    int cur_y = y + offset_y;
+
+                    if(cur_x >= 0 && cur_x < R && cur_y >= 0 && cur_y < C && !(cur_x == x && cur_y == y))
+                    {
+                        table.index[cell][table.count[cell]++] = cur_x * C + cur_y;
+                    }
+                }
+            }
+        }
+    }
+
+    return table;
+}
+
+template<int R, int C>
+class Board
+{
+    private:
+
+    static constexpr NeighborTable<R, C> NEIGHBORS = make_neighbor_table<R, C>();
+
+    std::array<int8_t, R * C> cells;
+
+    public:
+
+    static constexpr int ncols = C;
+
+    Board(Matrix& board)
+    {
+        for(int row = 0; row < R; ++row)
+        {
+            for(int col = 0; col < C; ++col)
+            {
+                cells[row * C + col] = board(row, col);
+            }
+        }
+    }
+
+    int8_t& operator[](int cell) { return cells[cell]; }
+    CellNeighbors neighbors(int cell) const { return CellNeighbors{NEIGHBORS.index[cell].data(), NEIGHBORS.index[cell].data() + NEIGHBORS.count[cell]}; }
+};
+
+/*
+    The deductions that only need one hint at a time, on a normalized board. A hint with as many hidden neighbors as its value makes all of them mines,
+    and a hint with a value of 0, or one that touches as many of those new mines as its value, makes the rest of its hidden neighbors safe.
+
+    Returns true and sets move to a safe cell if one is found. The mines found along the way are then added to mines. Returns false, and adds nothing,
+    if no safe cell can be found this way.
+*/
+template<class BoardType>
+bool trivial_move(BoardType& board, const std::vector<std::pair<int, int> >& hints, std::vector<int>& mines, int& move)
+{
+    // Known mines are -2 on a normalized board and have already been taken off the hints, so mines found here are marked apart from them.
+    const int8_t NEW_MINE = -3;
+    size_t first_mine = mines.size();
+
+    for(const std::pair<int, int>& hint : hints)
+    {
+        int cell = hint.first * board.ncols + hint.second;
+        int value = board[cell];
+        int hidden = 0;
+        int safe = -1;
+
+        for(int neighbor : board.neighbors(cell))
+        {
+            hidden += board[neighbor] == -1 || board[neighbor] == NEW_MINE;
+            safe = board[neighbor] == -1 ? neighbor : safe;
+        }
+
+        if(value == 0 && safe != -1)
+        {
+            move = safe;
+            return true;
+        }
+        if(value > 0 && value == hidden)
+        {
+            for(int neighbor : board.neighbors(cell))
+            {
+                if(board[neighbor] == -1)
+                {
+                    board[neighbor] = NEW_MINE;
+                    mines.push_back(neighbor);
+                }
+            }
+        }
+    }
+
+    if(mines.size() > first_mine)
+    {
+        for(const std::pair<int, int>& hint : hints)
+        {
+            int cell = hint.first * board.ncols + hint.second;
+            int new_mines = 0;
+            int safe = -1;
+
+            for(int neighbor : board.neighbors(cell))
+            {
+                new_mines += board[neighbor] == NEW_MINE;
+                safe = board[neighbor] == -1 ? neighbor : safe;
+            }
+
+            if(safe != -1 && board[cell] == new_mines)
+            {
+                move = safe;
+                return true;
+            }
+        }
+    }
+
+    mines.resize(first_mine);
+    return false;
+}
+
+bool find_trivial_move(Matrix& board, const std::vector<std::pair<int, int> >& hints, std::vector<std::pair<int, int> >& mines, std::pair<int, int>& move);
@@ -1,33 +1,188 @@
 #include "matrix.hpp"
 
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
 #include <iomanip>
+#include <numeric>
 
-Matrix::Matrix()
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Round a row length up to a whole number of SIMD registers.
+static int padded_width(int num_cols)
 {
+    return (num_cols + Matrix::ROW_ALIGNMENT - 1) / Matrix::ROW_ALIGNMENT * Matrix::ROW_ALIGNMENT;
+}
 
+// dst[i] += src[i] over a padded row.
+static void add_row_kernel(Matrix::value_type* dst, const Matrix::value_type* src, int size)
+{
+#if defined(__AVX2__)
+    for(int i = 0; i < size; i += 16)
+    {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_add_epi16(a, b));
+    }
+#elif defined(__SSE2__)
+    for(int i = 0; i < size; i += 8)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi16(a, b));
+    }
+#else
+    for(int i = 0; i < size; ++i)
+    {
+        dst[i] += src[i];
+    }
+#endif
+}
+
+// dst[i] -= src[i] over a padded row.
+static void subtract_row_kernel(Matrix::value_type* dst, const Matrix::value_type* src, int size)
+{
+#if defined(__AVX2__)
+    for(int i = 0; i < size; i += 16)
+    {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_sub_epi16(a, b));
+    }
+#elif defined(__SSE2__)
+    for(int i = 0; i < size; i += 8)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_sub_epi16(a, b));
+    }
+#else
+    for(int i = 0; i < size; ++i)
+    {
+        dst[i] -= src[i];
+    }
+#endif
+}
+
+// dst[i] -= factor * src[i] over a padded row.
+static void subtract_scaled_row_kernel(Matrix::value_type* dst, const Matrix::value_type* src, int factor, int size)
+{
+#if defined(__AVX2__)
+    const __m256i f = _mm256_set1_epi16(factor);
+    for(int i = 0; i < size; i += 16)
+    {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_sub_epi16(a, _mm256_mullo_epi16(b, f)));
+    }
+#elif defined(__SSE2__)
+    const __m128i f = _mm_set1_epi16(factor);
+    for(int i = 0; i < size; i += 8)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_sub_epi16(a, _mm_mullo_epi16(b, f)));
+    }
+#else
+    for(int i = 0; i < size; ++i)
+    {
+        dst[i] -= factor * src[i];
+    }
+#endif
+}
+
+// The largest |row[i]| over a padded row. Entries are never -32768, which has no positive counterpart, since rref keeps every entry within MAX_ENTRY.
+static int max_abs_kernel(const Matrix::value_type* row, int size)
+{
+#if defined(__AVX2__)
+    __m256i m = _mm256_setzero_si256();
+    for(int i = 0; i < size; i += 16)
+    {
+        m = _mm256_max_epi16(m, _mm256_abs_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i))));
+    }
+    __m128i half = _mm_max_epi16(_mm256_castsi256_si128(m), _mm256_extracti128_si256(m, 1));
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    __m128i half = zero;
+    for(int i = 0; i < size; i += 8)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        half = _mm_max_epi16(half, _mm_max_epi16(a, _mm_sub_epi16(zero, a)));
+    }
+#endif
+#if defined(__AVX2__) || defined(__SSE2__)
+    half = _mm_max_epi16(half, _mm_srli_si128(half, 8));
+    half = _mm_max_epi16(half, _mm_srli_si128(half, 4));
+    half = _mm_max_epi16(half, _mm_srli_si128(half, 2));
+    return static_cast<Matrix::value_type>(_mm_cvtsi128_si32(half));
+#else
+    int m = 0;
+    for(int i = 0; i < size; ++i)
+    {
+        m = std::max(m, std::abs(static_cast<int>(row[i])));
+    }
+    return m;
+#endif
+}
+
+// row[i] = -row[i] over a padded row. This is the only scaling other than by 1 that a 0/1 logic matrix normally needs.
+static void negate_row_kernel(Matrix::value_type* row, int size)
+{
+#if defined(__AVX2__)
+    const __m256i zero = _mm256_setzero_si256();
+    for(int i = 0; i < size; i += 16)
+    {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(row + i), _mm256_sub_epi16(zero, a));
+    }
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for(int i = 0; i < size; i += 8)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), _mm_sub_epi16(zero, a));
+    }
+#else
+    for(int i = 0; i < size; ++i)
+    {
+        row[i] = -row[i];
+    }
+#endif
+}
+
+Matrix::Matrix()
+{
+    stride = 0;
+    geometry = nullptr;
+    width = 0;
+    height = 0;
 }
 
 Matrix::Matrix(int num_rows, int num_cols)
 {
-	data = std::vector<std::vector<int> >(num_rows, std::vector<int>(num_cols));
-	width = num_cols;
-	height = num_rows;
+    stride = padded_width(num_cols);
+    data = std::vector<value_type>(num_rows * stride);
+    geometry = nullptr;
+    width = num_cols;
+    height = num_rows;
 }
 
-Matrix::Matrix(const std::vector<std::vector<int> >& d)
+Matrix::Matrix(const std::vector<std::vector<int> >& d) : Matrix(d.size(), d[0].size())
 {
-	data = d;
-	width = d[0].size();
-	height = d.size();
+    for(int row = 0; row < height; ++row)
+    {
+        for(int col = 0; col < width; ++col)
+        {
+            (*this)(row, col) = d[row][col];
+        }
+    }
 }
 
-Matrix::Matrix(std::vector<std::vector<int> >&& d)
+Matrix::Matrix(std::vector<std::vector<int> >&& d) : Matrix(static_cast<const std::vector<std::vector<int> >&>(d))
 {
-	data = std::move(d);
-	width = data[0].size();
-	height = data.size();
+
 }
 
 Matrix::~Matrix()
@@ -35,58 +190,120 @@ Matrix::~Matrix()
 
 }
 
-std::vector<int>& Matrix::operator()(int index)
+// Resize to num_rows by num_cols and zero every entry, keeping the buffer if it is already big enough.
+void Matrix::reset(int num_rows, int num_cols)
 {
-	return data.at(index);
+    stride = padded_width(num_cols);
+    data.assign(num_rows * stride, 0);
+    if(width != num_cols || height != num_rows)
+    {
+        geometry = nullptr;
+    }
+    width = num_cols;
+    height = num_rows;
 }
 
-int& Matrix::operator()(int index1, int index2)
+void Matrix::swap_rows(int row1, int row2)
 {
-	return data.at(index1).at(index2);
+    std::swap_ranges((*this)(row1), (*this)(row1) + stride, (*this)(row2));
 }
 
-void Matrix::swap_rows(int row1, int row2)
+// Divide a row through by divisor. Returns false and leaves the row alone if that would leave a fraction.
+bool Matrix::divide_row(int row, int divisor)
 {
-    data[row1].swap(data[row2]);
+    if(divisor == 1)
+    {
+        return true;
+    }
+    if(divisor == -1)
+    {
+        negate_row_kernel((*this)(row), stride);
+        return true;
+    }
+
+    value_type* r = (*this)(row);
+    for(int i = 0; i < width; ++i)
+    {
+        if(r[i] % divisor != 0)
+        {
+            return false;
+        }
+    }
+    for(int i = 0; i < width; ++i)
+    {
+        r[i] /= divisor;
+    }
+    return true;
 }
 
-void Matrix::divide_row(int row, int divisor)
+void Matrix::scale_row(int row, int factor)
 {
-    int size = data[row].size();
-    for(int i = 0; i < size; ++i)
+    value_type* r = (*this)(row);
+    for(int i = 0; i < width; ++i)
     {
-        data[row][i] /= divisor;
+        r[i] *= factor;
     }
 }
 
-void Matrix::add_row(int row1, int row2)
+// Divide a row by the gcd of its entries, so that rows scaled for a pivot that isn't 1 or -1 don't keep growing.
+void Matrix::reduce_row(int row)
 {
-    int size = data[row1].size();
-    for(int i = 0; i < size; ++i)
+    value_type* r = (*this)(row);
+    int divisor = 0;
+    for(int i = 0; i < width && divisor != 1; ++i)
+    {
+        divisor = std::gcd(divisor, std::abs(static_cast<int>(r[i])));
+    }
+    if(divisor > 1)
     {
-        data[row1][i] += data[row2][i];
+        for(int i = 0; i < width; ++i)
+        {
+            r[i] /= divisor;
+        }
     }
 }
 
+void Matrix::add_row(int row1, int row2)
+{
+    add_row_kernel((*this)(row1), (*this)(row2), stride);
+}
+
 void Matrix::subtract_row(int row1, int row2)
 {
-    int size = data[row1].size();
-    for(int i = 0; i < size; ++i)
+    subtract_row_kernel((*this)(row1), (*this)(row2), stride);
+}
+
+void Matrix::subtract_scaled_row(int row1, int row2, int factor)
+{
+    if(factor == 1)
+    {
+        subtract_row(row1, row2);
+    }
+    else if(factor == -1)
+    {
+        add_row(row1, row2);
+    }
+    else
     {
-        data[row1][i] -= data[row2][i];
+        subtract_scaled_row_kernel((*this)(row1), (*this)(row2), factor, stride);
     }
 }
 
-void Matrix::rref()
+/*
+    Bring the matrix to reduced row echelon form with integer row operations. Before each row operation the largest entry it could produce is worked
+    out from the largest entries of the two rows, and if that is more than MAX_ENTRY, rref stops and returns false. The matrix is then only partly
+    reduced, and nothing should be read from it.
+*/
+bool Matrix::rref()
 {
     int i = 0, j = 0;
-    int nrows = data.size();
-    int ncols = data[0].size();
+    int nrows = height;
+    int ncols = width;
 
     while(i < nrows && j < ncols)
     {
         // Choose a pivot
-        if(data[i][j] == 0)
+        if((*this)(i, j) == 0)
         {
             bool done = false;
             while(!done)
@@ -94,12 +311,12 @@ void Matrix::rref()
                 if(j >= ncols)
                 {
                     swap_rows(nrows - 1, nrows - 2);
-                    return;
+                    return true;
                 }
                 
                for (int n = i + 1; n < nrows; ++n)
 				{
-					if (data[n][j] != 0)
+					if ((*this)(n, j) != 0)
 					{
 						swap_rows(i, n);
 						done = true;
@@ -110,8 +327,8 @@ void Matrix::rref()
 				{
 					j++;
 					if (j >= ncols)
-						return;
-					if (data[i][j] != 0)
+						return true;
+					if ((*this)(i, j) != 0)
 					{
 						done = true;
 					}
@@ -119,25 +336,31 @@ void Matrix::rref()
             }
         }
 
-        // Divide row by pivot value, to make pivot equal 1
-		divide_row(i, data[i][j]);
+        // Divide row by pivot value, to make pivot equal 1. If the row isn't a multiple of the pivot, the other rows are scaled by it instead.
+		int pivot = (*this)(i, j);
+		bool unit_pivot = divide_row(i, pivot);
+		long long pivot_max = max_abs_kernel((*this)(i), stride);
 
 		//  Zero out column using pivot
 		for (int n = 0; n < nrows; ++n)
 		{
-			if (n != i && data[n][j] != 0)
+			if (n != i && (*this)(n, j) != 0)
 			{
-				int value = abs(data[n][j]);
-				for (int k = 0; k < value; ++k)
+				int factor = (*this)(n, j);
+				long long scale = unit_pivot ? 1 : std::abs(pivot);
+				if (max_abs_kernel((*this)(n), stride) * scale + std::abs(factor) * pivot_max > MAX_ENTRY)
 				{
-					if (data[n][j] < 0)
-					{
-						add_row(n, i);
-					}
-					else if (data[n][j] > 0)
-					{
-						subtract_row(n, i);
-					}
+					return false;
+				}
+
+				if (!unit_pivot)
+				{
+					scale_row(n, pivot);
+				}
+				subtract_scaled_row(n, i, factor);
+				if (!unit_pivot)
+				{
+					reduce_row(n);
 				}
 			}
 		}
@@ -145,31 +368,7 @@ void Matrix::rref()
 		j++;
     }
 
-	return;
-}
-
-std::vector<std::pair<int, int> > Matrix::get_adjacent_indices(int x, int y)
-{
-	int cur_x = 0, cur_y = 0;
-    std::vector<std::pair<int, int> > indexes;
-
-    for(int offset_x = -1; offset_x < 2; ++offset_x)
-    {
-        for(int offset_y = -1; offset_y < 2; ++offset_y)
-        {
-            cur_x = x + offset_x;
-            cur_y = y + offset_y;
-
-            // Make sure that we are not going out-of-bounds and are not checking self
-            if( cur_x >= 0 && cur_x < height &&
-                cur_y >= 0 && cur_y < width  &&
-                !(cur_x == x && cur_y == y))
-                {
-                    indexes.push_back(std::pair<int, int>(cur_x, cur_y));
-                }
-        }
-    }
-    return indexes;
+	return true;
 }
 
 // A row is lonely if there is only 1 non-zero entry besides the last one.
@@ -179,7 +378,7 @@ int Matrix::is_lonely_row(int row)
 	int col;
 	for (int i = 0; i < width - 1; ++i)
 	{
-		if (data[row][i] != 0)
+		if ((*this)(row, i) != 0)
 		{
 			count++;
 			col = i;
@@ -199,18 +398,18 @@ int Matrix::is_lonely_row(int row)
 // A row is "safe" if the final entry is 0, there is at least one entry of value 1, and no other entries are anything other than 1 or 0.
 bool Matrix::is_safe_row(int row)
 {
-    if (data[row][width - 1] != 0)
+    if ((*this)(row, width - 1) != 0)
 	{
 		return false;
 	}
 	bool at_least_one_positive = false;
 	for (int i = 0; i < width - 1; ++i)
 	{
-		if (data[row][i] == 1)
+		if ((*this)(row, i) == 1)
 		{
 			at_least_one_positive = true;
 		}
-		else if (data[row][i] != 1 && data[row][i] != 0)
+		else if ((*this)(row, i) != 1 && (*this)(row, i) != 0)
 		{
 			return false;
 		}
@@ -226,7 +425,7 @@ void Matrix::print()
 	{
 		for(int col = 0; col < width; ++col)
 		{
-			std::cout << std::setw(2) << data[row][col] << " ";
+			std::cout << std::setw(2) << (*this)(row, col) << " ";
 		}
 		std::cout << "\n";
 	}
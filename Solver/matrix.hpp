@@ -1,21 +1,42 @@
 /*
     Class that represents a mathematical matrix. Contains functions to convert matrix to reduced row-echelon form.
+
+    Entries are stored in a single row-major buffer. Each row is padded to a multiple of ROW_ALIGNMENT entries so that the row operations used during
+    elimination can run over whole SIMD registers without a scalar tail. Padding entries are always zero.
 */
 
 #pragma once
 
+#include "geometry.hpp"
+
+#include <cstdint>
+#include <utility>
 #include <vector>
 
 class Matrix
 {
+    public:
+
+    // Board cells hold -2..8 and logic matrix entries almost always stay small during elimination. rref checks every row operation against
+    // MAX_ENTRY and gives up on the rare matrix where they would not fit.
+    typedef int16_t value_type;
+
+    static const int ROW_ALIGNMENT = 16; // Entries per 32-byte AVX2 register.
+    static const int MAX_ENTRY = 32767;  // rref gives up rather than let an entry get bigger than this
+
     private:
 
-    std::vector<std::vector<int> > data;
+    std::vector<value_type> data;
+    int stride;
+    const BoardGeometry* geometry;  // Neighbor tables for this size, looked up the first time they are needed
 
     void swap_rows(int row1, int row2);
-    void divide_row(int row, int divisor);
+    bool divide_row(int row, int divisor);
+    void scale_row(int row, int factor);
+    void reduce_row(int row);
     void add_row(int row1, int row2);
     void subtract_row(int row1, int row2);
+    void subtract_scaled_row(int row1, int row2, int factor);
 
     public:
 
@@ -28,13 +49,22 @@ class Matrix
     Matrix(std::vector<std::vector<int> >&& d);
     ~Matrix();
 
-    std::vector<int>& operator()(int index);
-    int& operator()(int index1, int index2);
+    void reset(int num_rows, int num_cols);
+
+    value_type* operator()(int index) { return &data[index * stride]; }
+    value_type& operator()(int index1, int index2) { return data[index1 * stride + index2]; }
 
-    void rref();
-    std::vector<std::pair<int, int> > get_adjacent_indices(int x, int y);
+    bool rref();
+    NeighborRange get_adjacent_indices(int x, int y)
+    {
+        if(!geometry)
+        {
+            geometry = &BoardGeometry::get(height, width);
+        }
+        return geometry->adjacent(x, y);
+    }
     int is_lonely_row(int row);
     bool is_safe_row(int row);
 
     void print();
-};
\ No newline at end of file
+};
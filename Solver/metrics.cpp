@@ -0,0 +1,156 @@
+#include "metrics.hpp"
+
+#include <algorithm>
+
+static const char* metric_names[SolverMetrics::NUM_METRICS] = {
+    "total_ns", "trivial_ns", "pattern_ns", "propagation_ns", "logic_matrix_ns", "eliminate_ns", "guaranteed_ns", "safest_ns", "combinations_ns",
+    "frontier_cells", "logic_rows", "logic_cols", "components", "largest_component", "search_nodes", "cached_components", "capped_searches",
+    "truncated_components", "sampled_components", "estimated_components"
+};
+
+static const char* source_names[NUM_MOVE_SOURCES] = {"none", "first_move", "trivial", "pattern", "propagation", "guaranteed", "normalized", "safest"};
+
+const char* SolverMetrics::metric_name(Metric metric)
+{
+    return metric_names[metric];
+}
+
+const char* SolverMetrics::source_name(MoveSource source)
+{
+    return source_names[source];
+}
+
+SolverMetrics::SolverMetrics()
+{
+    calls = 0;
+    truncated_calls = 0;
+    std::fill(moves, moves + NUM_MOVE_SOURCES, 0);
+}
+
+SolverMetrics::~SolverMetrics()
+{
+
+}
+
+void SolverMetrics::sample(Metric metric, long long value)
+{
+    Summary& summary = summaries[metric];
+    ++summary.count;
+    summary.total += value;
+    summary.max = std::max(summary.max, value);
+}
+
+// Add one best_move call. Each phase's metrics are only sampled if the call got as far as that phase.
+void SolverMetrics::record(const SolverProfile& profile)
+{
+    ++calls;
+    ++moves[profile.source];
+    truncated_calls += profile.truncated_components > 0 || profile.estimated_components > 0;
+
+    sample(TOTAL_NS, profile.total_ns);
+    sample(FRONTIER_CELLS, profile.frontier_cells);
+
+    if(profile.source == SOURCE_FIRST_MOVE)
+    {
+        return;
+    }
+    sample(TRIVIAL_NS, profile.trivial_ns);
+
+    if(profile.source == SOURCE_TRIVIAL)
+    {
+        return;
+    }
+    sample(PATTERN_NS, profile.pattern_ns);
+
+    if(profile.source == SOURCE_PATTERN)
+    {
+        return;
+    }
+    sample(PROPAGATION_NS, profile.propagation_ns);
+
+    if(profile.source == SOURCE_PROPAGATION)
+    {
+        return;
+    }
+    sample(LOGIC_MATRIX_NS, profile.logic_matrix_ns);
+    sample(LOGIC_ROWS, profile.logic_rows);
+    sample(LOGIC_COLS, profile.logic_cols);
+    sample(ELIMINATE_NS, profile.eliminate_ns);
+    sample(GUARANTEED_NS, profile.guaranteed_ns);
+
+    if(profile.source != SOURCE_SAFEST)
+    {
+        return;
+    }
+    sample(SAFEST_NS, profile.safest_ns);
+    sample(COMBINATIONS_NS, profile.combinations_ns);
+    sample(COMPONENTS, profile.components);
+    sample(LARGEST_COMPONENT, profile.largest_component);
+    sample(SEARCH_NODES, profile.search_nodes);
+    sample(CACHED_COMPONENTS, profile.cached_components);
+    sample(CAPPED_SEARCHES, profile.capped_searches);
+    sample(TRUNCATED_COMPONENTS, profile.truncated_components);
+    sample(SAMPLED_COMPONENTS, profile.sampled_components);
+    sample(ESTIMATED_COMPONENTS, profile.estimated_components);
+}
+
+// Add everything recorded by another SolverMetrics, such as one kept by another thread.
+void SolverMetrics::merge(const SolverMetrics& other)
+{
+    calls += other.calls;
+    truncated_calls += other.truncated_calls;
+
+    for(int source = 0; source < NUM_MOVE_SOURCES; ++source)
+    {
+        moves[source] += other.moves[source];
+    }
+
+    for(int metric = 0; metric < NUM_METRICS; ++metric)
+    {
+        summaries[metric].count += other.summaries[metric].count;
+        summaries[metric].total += other.summaries[metric].total;
+        summaries[metric].max = std::max(summaries[metric].max, other.summaries[metric].max);
+    }
+}
+
+void SolverMetrics::write_json(std::ostream& out) const
+{
+    out << "{\n  \"calls\": " << calls << ",\n  \"truncated_calls\": " << truncated_calls << ",\n  \"moves\": {";
+
+    for(int source = 0; source < NUM_MOVE_SOURCES; ++source)
+    {
+        out << (source ? ", " : "") << "\"" << source_names[source] << "\": " << moves[source];
+    }
+
+    out << "},\n  \"metrics\": {\n";
+    for(int metric = 0; metric < NUM_METRICS; ++metric)
+    {
+        const Summary& summary = summaries[metric];
+        double mean = summary.count ? static_cast<double>(summary.total) / summary.count : 0.0;
+
+        out << "    \"" << metric_names[metric] << "\": {\"count\": " << summary.count << ", \"total\": " << summary.total
+            << ", \"mean\": " << mean << ", \"max\": " << summary.max << "}" << (metric + 1 < NUM_METRICS ? ",\n" : "\n");
+    }
+    out << "  }\n}\n";
+}
+
+// One row per metric, followed by the call and move counts as rows with only a count.
+void SolverMetrics::write_csv(std::ostream& out) const
+{
+    out << "metric,count,total,mean,max\n";
+
+    for(int metric = 0; metric < NUM_METRICS; ++metric)
+    {
+        const Summary& summary = summaries[metric];
+        double mean = summary.count ? static_cast<double>(summary.total) / summary.count : 0.0;
+
+        out << metric_names[metric] << "," << summary.count << "," << summary.total << "," << mean << "," << summary.max << "\n";
+    }
+
+    out << "calls," << calls << ",,,\n";
+    out << "truncated_calls," << truncated_calls << ",,,\n";
+    for(int source = 0; source < NUM_MOVE_SOURCES; ++source)
+    {
+        out << "moves_" << source_names[source] << "," << moves[source] << ",,,\n";
+    }
+}
@@ -0,0 +1,119 @@
+/*
+    Per-call instrumentation of the Solver.
+
+    Every best_move call fills in a SolverProfile: how long each phase took, how big the frontier and the logic matrix were, how much searching was done,
+    and which phase the move came from. A Solver only hands its profiles to a SolverMetrics if one has been attached with set_metrics, so a Solver without
+    one pays for nothing beyond filling in the profile.
+
+    SolverMetrics keeps a running count, total and maximum of every metric. Each thread should have its own, merged once the threads are done, and the
+    result can be written out as JSON or CSV.
+*/
+
+#pragma once
+
+#include <ostream>
+
+// The phase of best_move that the move came from.
+enum MoveSource
+{
+    SOURCE_NONE,
+    SOURCE_FIRST_MOVE,
+    SOURCE_TRIVIAL,         // find_trivial_move
+    SOURCE_PATTERN,         // find_pattern_move
+    SOURCE_PROPAGATION,     // find_propagated_move
+    SOURCE_GUARANTEED,      // find_guaranteed_move
+    SOURCE_NORMALIZED,      // find_move_from_normalized_board
+    SOURCE_SAFEST,          // find_safest_move
+    NUM_MOVE_SOURCES
+};
+
+// What happened during the most recent best_move call. Times are wall-clock nanoseconds, and are 0 for a phase that did not run.
+struct SolverProfile
+{
+    long long total_ns = 0;
+    long long trivial_ns = 0;           // find_trivial_move
+    long long pattern_ns = 0;           // find_pattern_move
+    long long propagation_ns = 0;       // find_propagated_move
+    long long logic_matrix_ns = 0;      // construct_logic_matrix
+    long long eliminate_ns = 0;         // SparseSystem::eliminate, 0 when a SolverSession keeps the system eliminated
+    long long guaranteed_ns = 0;        // find_guaranteed_move
+    long long safest_ns = 0;            // find_safest_move, 0 if a guaranteed move was found
+    long long combinations_ns = 0;      // Part of safest_ns
+
+    int frontier_cells = 0;
+    int logic_rows = 0;                 // 0 if the logic matrix was not built
+    int logic_cols = 0;
+    int components = 0;                 // Frontier components searched by find_safest_move
+    int largest_component = 0;          // Cells in the largest of them
+    long long search_nodes = 0;         // Search nodes visited over all components
+    int cached_components = 0;          // Components whose solutions were taken from the ComponentCache instead of searched
+    int capped_searches = 0;            // Component searches that ran out of nodes or time, whatever was done instead. A component can count more than once under a deadline.
+    int truncated_components = 0;       // Components whose search ran out of nodes, so their probabilities are approximate
+    int sampled_components = 0;         // Components too large to enumerate, whose probabilities were sampled
+    int estimated_components = 0;       // Components that could neither be searched nor sampled in time, so their probabilities were estimated from their hints
+    MoveSource source = SOURCE_NONE;
+};
+
+class SolverMetrics
+{
+    public:
+
+    enum Metric
+    {
+        TOTAL_NS,
+        TRIVIAL_NS,
+        PATTERN_NS,
+        PROPAGATION_NS,
+        LOGIC_MATRIX_NS,
+        ELIMINATE_NS,
+        GUARANTEED_NS,
+        SAFEST_NS,
+        COMBINATIONS_NS,
+        FRONTIER_CELLS,
+        LOGIC_ROWS,
+        LOGIC_COLS,
+        COMPONENTS,
+        LARGEST_COMPONENT,
+        SEARCH_NODES,
+        CACHED_COMPONENTS,
+        CAPPED_SEARCHES,
+        TRUNCATED_COMPONENTS,
+        SAMPLED_COMPONENTS,
+        ESTIMATED_COMPONENTS,
+        NUM_METRICS
+    };
+
+    // Samples of one metric. A metric is only sampled on calls that reached the phase it belongs to.
+    struct Summary
+    {
+        long long count = 0;
+        long long total = 0;
+        long long max = 0;
+    };
+
+    static const char* metric_name(Metric metric);
+    static const char* source_name(MoveSource source);
+
+    SolverMetrics();
+    ~SolverMetrics();
+
+    void record(const SolverProfile& profile);
+    void merge(const SolverMetrics& other);
+
+    long long num_calls() const { return calls; }
+    long long num_truncated_calls() const { return truncated_calls; }
+    long long moves_from(MoveSource source) const { return moves[source]; }
+    const Summary& summary(Metric metric) const { return summaries[metric]; }
+
+    void write_json(std::ostream& out) const;
+    void write_csv(std::ostream& out) const;
+
+    private:
+
+    long long calls;
+    long long truncated_calls;      // Calls where at least one component search ran out of nodes or time
+    long long moves[NUM_MOVE_SOURCES];
+    Summary summaries[NUM_METRICS];
+
+    void sample(Metric metric, long long value);
+};
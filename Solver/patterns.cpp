@@ -0,0 +1,144 @@
+#include "patterns.hpp"
+#include "geometry.hpp"
+
+#include <cstdlib>
+
+#include "pattern_table.inc"
+
+// Where the second hint of a pair can be relative to the first, for every pair whose neighborhoods overlap. Each pair is only tried once.
+static const std::pair<int, int> PAIR_OFFSETS[] = {
+    {0, 1}, {0, 2}, {1, -2}, {1, -1}, {1, 0}, {1, 1}, {1, 2}, {2, -2}, {2, -1}, {2, 0}, {2, 1}, {2, 2}
+};
+
+// The flags the table has for a pair, or 0 if it forces nothing.
+static uint32_t lookup_pattern(uint32_t key)
+{
+    uint32_t seed = PATTERN_SEEDS[pattern_hash(key, 0) % PATTERN_BUCKETS];
+    uint32_t entry = PATTERN_TABLE[pattern_hash(key, seed) % PATTERN_SLOTS];
+
+    return entry >> PATTERN_FLAG_BITS == key ? entry & ((1 << PATTERN_FLAG_BITS) - 1) : 0;
+}
+
+static bool touches(const std::pair<int, int>& a, const std::pair<int, int>& b)
+{
+    return std::abs(a.first - b.first) <= 1 && std::abs(a.second - b.second) <= 1;
+}
+
+/*
+    The deductions that come from two hints at a time, on a normalized board that the trivial deductions have found nothing on. Every pair of hints that
+    share hidden neighbors is looked up in the pattern table.
+
+    Returns true and sets move to a safe cell if one is found, either straight from a pair or from a hint that the mines found by the pairs fill up. The
+    mines found along the way are then added to mines. Returns false, and adds nothing, if no safe cell can be found this way.
+*/
+bool find_pattern_move(Matrix& board, const std::vector<std::pair<int, int> >& hints, std::vector<std::pair<int, int> >& mines, std::pair<int, int>& move)
+{
+    const BoardGeometry& geometry = BoardGeometry::get(board.height, board.width);
+    std::vector<bool> open(board.height * board.width);     // Hints that one hint at a time can't settle
+    std::vector<bool> is_mine(board.height * board.width);
+    size_t first_mine = mines.size();
+
+    for(const std::pair<int, int>& hint : hints)
+    {
+        int hidden = 0;
+        for(const std::pair<int, int>& index : geometry.adjacent(hint.first, hint.second))
+        {
+            hidden += board(index.first, index.second) == -1;
+        }
+        open[hint.first * board.width + hint.second] = board(hint.first, hint.second) > 0 && board(hint.first, hint.second) < hidden;
+    }
+
+    for(const std::pair<int, int>& first : hints)
+    {
+        if(!open[first.first * board.width + first.second])
+        {
+            continue;
+        }
+
+        for(const std::pair<int, int>& offset : PAIR_OFFSETS)
+        {
+            std::pair<int, int> second(first.first + offset.first, first.second + offset.second);
+            if(second.first < 0 || second.first >= board.height || second.second < 0 || second.second >= board.width || !open[second.first * board.width + second.second])
+            {
+                continue;
+            }
+
+            int only_first = 0;
+            int shared = 0;
+            int only_second = 0;
+            for(const std::pair<int, int>& index : geometry.adjacent(first.first, first.second))
+            {
+                if(board(index.first, index.second) == -1 && touches(index, second))
+                {
+                    ++shared;
+                }
+                else if(board(index.first, index.second) == -1)
+                {
+                    ++only_first;
+                }
+            }
+            for(const std::pair<int, int>& index : geometry.adjacent(second.first, second.second))
+            {
+                only_second += board(index.first, index.second) == -1 && !touches(index, first);
+            }
+
+            uint32_t flags = shared ? lookup_pattern(pattern_key(only_first, shared, only_second, board(first.first, first.second), board(second.first, second.second))) : 0;
+            if(!flags)
+            {
+                continue;
+            }
+
+            // Hidden neighbors of either hint, sorted into their groups. A flagged group is either all safe or all mines.
+            for(const std::pair<int, int>& hint : {first, second})
+            {
+                for(const std::pair<int, int>& index : geometry.adjacent(hint.first, hint.second))
+                {
+                    if(board(index.first, index.second) != -1)
+                    {
+                        continue;
+                    }
+
+                    bool near_first = touches(index, first);
+                    bool near_second = touches(index, second);
+                    uint32_t group = near_first && near_second ? PATTERN_SHARED_SAFE : near_first ? PATTERN_FIRST_SAFE : PATTERN_SECOND_SAFE;
+
+                    if(flags & group)
+                    {
+                        move = index;
+                        return true;
+                    }
+                    if((flags & group << 1) && !is_mine[index.first * board.width + index.second])
+                    {
+                        is_mine[index.first * board.width + index.second] = true;
+                        mines.push_back(index);
+                    }
+                }
+            }
+        }
+    }
+
+    if(mines.size() > first_mine)
+    {
+        for(const std::pair<int, int>& hint : hints)
+        {
+            int new_mines = 0;
+            int safe = -1;
+
+            for(const std::pair<int, int>& index : geometry.adjacent(hint.first, hint.second))
+            {
+                int cell = index.first * board.width + index.second;
+                new_mines += is_mine[cell];
+                safe = board(index.first, index.second) == -1 && !is_mine[cell] ? cell : safe;
+            }
+
+            if(safe != -1 && board(hint.first, hint.second) == new_mines)
+            {
+                move = {safe / board.width, safe % board.width};
+                return true;
+            }
+        }
+    }
+
+    mines.resize(first_mine);
+    return false;
+}
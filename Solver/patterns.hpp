@@ -0,0 +1,49 @@
+/*
+    Deductions from pairs of nearby hints, looked up in a table that is generated when the library is built.
+
+    Two hints whose neighborhoods overlap split their hidden neighbors into three groups: the cells next to only the first hint, the cells next to both,
+    and the cells next to only the second. Whether a group must be all safe or all mines depends on nothing but the two values and the size of each group,
+    so Tools/pattern_generator.cpp works out every case ahead of time and writes them out as a perfect hash table, which is compiled into the library. This
+    covers the 1-1 and 1-2 patterns along a wall, and most other forced moves that one hint at a time can't find, without building the logic matrix.
+
+    The table's keys and hash are defined here so that the generator and the lookup agree on them.
+*/
+
+#pragma once
+
+#include "matrix.hpp"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// What a pair of hints forces on each of its groups of cells.
+enum PatternFlag
+{
+    PATTERN_FIRST_SAFE = 1,
+    PATTERN_FIRST_MINE = 2,
+    PATTERN_SHARED_SAFE = 4,
+    PATTERN_SHARED_MINE = 8,
+    PATTERN_SECOND_SAFE = 16,
+    PATTERN_SECOND_MINE = 32
+};
+
+const int PATTERN_FLAG_BITS = 6;
+const uint32_t PATTERN_EMPTY = 0xffffffff;     // Table slot with no entry. Its key is wider than any real key.
+
+// Group sizes are at most 8, 4 and 8, and only values from 1 to 7 are looked up, since the trivial deductions settle any hint of 0 or of a full 8.
+inline uint32_t pattern_key(int only_first, int shared, int only_second, int first_value, int second_value)
+{
+    return only_first | shared << 4 | only_second << 7 | first_value << 11 | second_value << 14;
+}
+
+inline uint32_t pattern_hash(uint32_t key, uint32_t seed)
+{
+    uint32_t hash = (key ^ (seed * 0x85ebca6bu)) * 0x9e3779b1u;
+    hash ^= hash >> 15;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 13;
+    return hash;
+}
+
+bool find_pattern_move(Matrix& board, const std::vector<std::pair<int, int> >& hints, std::vector<std::pair<int, int> >& mines, std::pair<int, int>& move);
@@ -0,0 +1,121 @@
+#include "probability.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+ProbabilityEngine::ProbabilityEngine() : log_factorials(1, 0.0)
+{
+    outside_probability = 0.0;
+}
+
+ProbabilityEngine::~ProbabilityEngine()
+{
+
+}
+
+// Natural log of the binomial coefficient C(n, k). The factorial table grows as larger boards are seen.
+double ProbabilityEngine::log_choose(int n, int k)
+{
+    while(static_cast<int>(log_factorials.size()) <= n)
+    {
+        log_factorials.push_back(log_factorials.back() + std::log(static_cast<double>(log_factorials.size())));
+    }
+    return log_factorials[n] - log_factorials[k] - log_factorials[n - k];
+}
+
+// Combine the mine count distributions of two independent groups of cells into the distribution of their union.
+std::vector<double> ProbabilityEngine::convolve(const std::vector<double>& a, const std::vector<double>& b)
+{
+    std::vector<double> result(a.size() + b.size() - 1);
+
+    for(size_t i = 0; i < a.size(); ++i)
+    {
+        if(a[i] == 0)
+        {
+            continue;
+        }
+        for(size_t j = 0; j < b.size(); ++j)
+        {
+            result[i + j] += a[i] * b[j];
+        }
+    }
+
+    return result;
+}
+
+// Compute mine probabilities for every component cell and for the cells off the frontier. Returns false if no placement is consistent with the mine count.
+bool ProbabilityEngine::solve(std::vector<SolutionAccumulator>& components, int outside_cells, int remaining_mines)
+{
+    size_t num_components = components.size();
+
+    // prefix_counts[c] covers components before c, suffix_counts[c] covers components from c onward.
+    std::vector<std::vector<double> > prefix_counts(num_components + 1, std::vector<double>{1.0});
+    std::vector<std::vector<double> > suffix_counts(num_components + 1, std::vector<double>{1.0});
+    for(size_t c = 0; c < num_components; ++c)
+    {
+        prefix_counts[c + 1] = convolve(prefix_counts[c], components[c].totals);
+        suffix_counts[num_components - c - 1] = convolve(components[num_components - c - 1].totals, suffix_counts[num_components - c]);
+    }
+    std::vector<double>& frontier_counts = prefix_counts[num_components];
+
+    // weights[t] is proportional to the number of ways to place the other remaining_mines - t mines off the frontier.
+    std::vector<double> weights(frontier_counts.size());
+    double max_log_weight = -std::numeric_limits<double>::infinity();
+    for(size_t t = 0; t < weights.size(); ++t)
+    {
+        int outside_mines = remaining_mines - t;
+        if(frontier_counts[t] > 0 && outside_mines >= 0 && outside_mines <= outside_cells)
+        {
+            weights[t] = log_choose(outside_cells, outside_mines);
+            max_log_weight = std::max(max_log_weight, weights[t]);
+        }
+        else
+        {
+            weights[t] = -std::numeric_limits<double>::infinity();
+        }
+    }
+    if(max_log_weight == -std::numeric_limits<double>::infinity())
+    {
+        return false;
+    }
+
+    double total_weight = 0.0;
+    double outside_mines = 0.0;
+    for(size_t t = 0; t < weights.size(); ++t)
+    {
+        weights[t] = std::exp(weights[t] - max_log_weight);
+        total_weight += frontier_counts[t] * weights[t];
+        outside_mines += frontier_counts[t] * weights[t] * (remaining_mines - static_cast<int>(t));
+    }
+    outside_probability = outside_cells > 0 ? outside_mines / total_weight / outside_cells : 0.0;
+
+    // A component placement with k mines is weighted by every way the other components and the outside cells can make up the rest.
+    cell_probabilities = std::vector<std::vector<double> >(num_components);
+    for(size_t c = 0; c < num_components; ++c)
+    {
+        SolutionAccumulator& solutions = components[c];
+        std::vector<double> other_counts = convolve(prefix_counts[c], suffix_counts[c + 1]);
+
+        cell_probabilities[c] = std::vector<double>(solutions.num_cells());
+        for(size_t k = 0; k < solutions.totals.size(); ++k)
+        {
+            if(solutions.totals[k] == 0)
+            {
+                continue;
+            }
+
+            double weight = 0.0;
+            for(size_t j = 0; j < other_counts.size() && k + j < weights.size(); ++j)
+            {
+                weight += other_counts[j] * weights[k + j];
+            }
+            for(int cell = 0; cell < solutions.num_cells(); ++cell)
+            {
+                cell_probabilities[c][cell] += solutions.cell_mines[k][cell] * weight / total_weight;
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,37 @@
+/*
+    Computes the exact probability that each frontier cell, and any cell off the frontier, contains a mine.
+
+    Every placement of mines on the frontier is equally likely to be extended to a full board, except that a placement with t mines leaves R - t of
+    the remaining mines to be spread over the O hidden cells off the frontier, which can be done in C(O, R - t) ways. Each placement is weighted by
+    that count. Combining the components by convolution gives the weight of every cell in a single pass over the per-mine-count tallies.
+
+    Binomial coefficients are taken from a table of log-factorials and scaled by the largest one before exponentiating, so boards with hundreds of
+    hidden cells do not overflow.
+*/
+
+#pragma once
+
+#include "accumulator.hpp"
+
+#include <vector>
+
+class ProbabilityEngine
+{
+    private:
+
+    std::vector<double> log_factorials;
+
+    double log_choose(int n, int k);
+
+    public:
+
+    std::vector<std::vector<double> > cell_probabilities;   // cell_probabilities[c][cell] for each component c
+    double outside_probability;                             // Probability for each hidden cell that is not on the frontier
+
+    ProbabilityEngine();
+    ~ProbabilityEngine();
+
+    bool solve(std::vector<SolutionAccumulator>& components, int outside_cells, int remaining_mines);
+
+    static std::vector<double> convolve(const std::vector<double>& a, const std::vector<double>& b);
+};
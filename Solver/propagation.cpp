@@ -0,0 +1,270 @@
+#include "propagation.hpp"
+#include "geometry.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+// At most 8 cells, since every constraint is a hint's hidden neighbors or a subset of them.
+struct PropagatedConstraint
+{
+    int cells[8];       // Sorted cell numbers, row * width + col
+    int size;
+    int value;
+
+    const int* begin() const { return cells; }
+    const int* end() const { return cells + size; }
+};
+
+class Propagator
+{
+    private:
+
+    const int MAX_DERIVED_PER_HINT = 2;     // Bounds the constraints that subsets can add, so a large frontier can't keep the propagation going for long
+
+    struct Link
+    {
+        int constraint;
+        int next;
+    };
+
+    int width;
+    std::vector<PropagatedConstraint> constraints;
+    std::vector<int> cell_head;             // Constraints that have each cell, as linked lists. A settled cell's list is emptied.
+    std::vector<Link> links;
+    std::vector<bool> is_mine;
+    std::vector<uint64_t> seen;             // Sorted keys of every constraint so far, so none is added twice
+    size_t max_constraints;
+
+    std::vector<int> queue;                 // Constraints that changed since they were last looked at
+    size_t head;
+    std::vector<bool> queued;
+    std::vector<int> partners;
+
+    // The cells of a constraint all fit in a 3x3 window, so its corner and which of the window's cells it has make a key that no other set of cells shares.
+    uint64_t key(const PropagatedConstraint& constraint)
+    {
+        int top = constraint.cells[0] / width;
+        int left = constraint.cells[0] % width;
+        for(int cell : constraint)
+        {
+            left = std::min(left, cell % width);
+        }
+
+        uint64_t mask = 0;
+        for(int cell : constraint)
+        {
+            mask |= uint64_t(1) << ((cell / width - top) * 3 + cell % width - left);
+        }
+        return uint64_t(top * width + left) << 9 | mask;
+    }
+
+    void enqueue(int c)
+    {
+        if(!queued[c])
+        {
+            queued[c] = true;
+            queue.push_back(c);
+        }
+    }
+
+    void add_constraint(const PropagatedConstraint& constraint)
+    {
+        uint64_t k = key(constraint);
+        auto it = std::lower_bound(seen.begin(), seen.end(), k);
+        if(it != seen.end() && *it == k)
+        {
+            return;
+        }
+        seen.insert(it, k);
+
+        int c = constraints.size();
+        constraints.push_back(constraint);
+        queued.push_back(false);
+        for(int cell : constraint)
+        {
+            links.push_back({c, cell_head[cell]});
+            cell_head[cell] = links.size() - 1;
+        }
+        enqueue(c);
+    }
+
+    // Take a mine out of every constraint that has it.
+    void settle_mine(int cell)
+    {
+        if(is_mine[cell])
+        {
+            return;
+        }
+        is_mine[cell] = true;
+        mines.push_back(cell);
+
+        for(int link = cell_head[cell]; link != -1; link = links[link].next)
+        {
+            PropagatedConstraint& constraint = constraints[links[link].constraint];
+            int* last = std::remove(constraint.cells, constraint.cells + constraint.size, cell);
+            constraint.size = last - constraint.cells;
+            --constraint.value;
+            enqueue(links[link].constraint);
+        }
+        cell_head[cell] = -1;
+    }
+
+    // What follows from a constraint on its own. Returns true if any cell was settled. Otherwise a constraint that isn't known yet is added.
+    bool deduce(const PropagatedConstraint& constraint)
+    {
+        if(constraint.size == 0)
+        {
+            return false;
+        }
+        if(constraint.value == 0)
+        {
+            safe = constraint.cells[0];
+            return true;
+        }
+        if(constraint.value == constraint.size)
+        {
+            for(int cell : constraint)
+            {
+                settle_mine(cell);
+            }
+            return true;
+        }
+
+        if(constraints.size() < max_constraints)
+        {
+            add_constraint(constraint);
+        }
+        return false;
+    }
+
+    // If one constraint's cells are a strict subset of the other's, the rest of the other's cells hold the difference of their values.
+    bool compare(int a, int b)
+    {
+        if(constraints[a].size > constraints[b].size)
+        {
+            std::swap(a, b);
+        }
+        const PropagatedConstraint& small = constraints[a];
+        const PropagatedConstraint& large = constraints[b];
+
+        if(small.size == large.size || !std::includes(large.begin(), large.end(), small.begin(), small.end()))
+        {
+            return false;
+        }
+
+        PropagatedConstraint rest;
+        rest.size = std::set_difference(large.begin(), large.end(), small.begin(), small.end(), rest.cells) - rest.cells;
+        rest.value = large.value - small.value;
+        return deduce(rest);
+    }
+
+    // Look at one constraint on its own and against every constraint it shares a cell with. Stops at the first cell it settles, since that changes
+    // the constraint, which puts it back in the queue.
+    void check(int c)
+    {
+        PropagatedConstraint constraint = constraints[c];
+        if(constraint.size == 0)
+        {
+            return;
+        }
+        if(constraint.value == 0 || constraint.value == constraint.size)
+        {
+            deduce(constraint);
+            return;
+        }
+
+        partners.clear();
+        for(int cell : constraint)
+        {
+            for(int link = cell_head[cell]; link != -1; link = links[link].next)
+            {
+                if(links[link].constraint != c)
+                {
+                    partners.push_back(links[link].constraint);
+                }
+            }
+        }
+        std::sort(partners.begin(), partners.end());
+        partners.erase(std::unique(partners.begin(), partners.end()), partners.end());
+
+        for(int other : partners)
+        {
+            if(compare(c, other) || safe != -1)
+            {
+                return;
+            }
+        }
+    }
+
+    public:
+
+    std::vector<int> mines;
+    int safe = -1;
+
+    Propagator(Matrix& board, const std::vector<std::pair<int, int> >& hints) : width(board.width), cell_head(board.height * board.width, -1), is_mine(board.height * board.width)
+    {
+        const BoardGeometry& geometry = BoardGeometry::get(board.height, board.width);
+        max_constraints = hints.size() * (1 + MAX_DERIVED_PER_HINT);
+        head = 0;
+
+        constraints.reserve(2 * hints.size());
+        queued.reserve(2 * hints.size());
+        seen.reserve(2 * hints.size());
+        links.reserve(16 * hints.size());
+
+        for(const std::pair<int, int>& hint : hints)
+        {
+            PropagatedConstraint constraint;
+            constraint.size = 0;
+            constraint.value = board(hint.first, hint.second);
+            for(const std::pair<int, int>& index : geometry.adjacent(hint.first, hint.second))
+            {
+                if(board(index.first, index.second) == -1)
+                {
+                    constraint.cells[constraint.size++] = index.first * board.width + index.second;
+                }
+            }
+            std::sort(constraint.cells, constraint.cells + constraint.size);
+
+            if(constraint.size > 0 && constraint.value >= 0)
+            {
+                add_constraint(constraint);
+            }
+        }
+    }
+
+    // Run until a safe cell is found or nothing more follows.
+    bool run()
+    {
+        while(head < queue.size() && safe == -1)
+        {
+            int c = queue[head++];
+            queued[c] = false;
+            check(c);
+        }
+        return safe != -1;
+    }
+};
+
+/*
+    The deductions that come from propagating the hints of a normalized board to a fixed point. Meant for boards that the trivial deductions and the
+    pattern table have found nothing on.
+
+    Returns true and sets move to a safe cell if one is found, and adds the mines found along the way to mines. Returns false, and adds nothing, if no
+    safe cell can be found this way.
+*/
+bool find_propagated_move(Matrix& board, const std::vector<std::pair<int, int> >& hints, std::vector<std::pair<int, int> >& mines, std::pair<int, int>& move)
+{
+    Propagator propagator(board, hints);
+    if(!propagator.run())
+    {
+        return false;
+    }
+
+    for(int cell : propagator.mines)
+    {
+        mines.push_back({cell / board.width, cell % board.width});
+    }
+    move = {propagator.safe / board.width, propagator.safe % board.width};
+    return true;
+}
@@ -0,0 +1,21 @@
+/*
+    Deductions from chains of hints, found by propagating constraints to a fixed point instead of building the logic matrix.
+
+    Each hint is a constraint: its hidden neighbors hold exactly its value in mines. A constraint of 0 makes all of its cells safe, and one whose value
+    is its size makes all of them mines. When the cells of one constraint are a subset of another's, the cells of the larger one that are not in the
+    smaller one hold the difference of their values, which is a new constraint in its own right. Each cell that is settled is taken out of every
+    constraint it is in, which can settle more cells in turn.
+
+    Constraints are found through an index from each cell to the constraints that have it, so only constraints that share a cell are ever compared.
+    This goes further than the pattern table, which looks at one pair of hints at a time, and still costs microseconds on positions the logic matrix
+    would take much longer to build and eliminate.
+*/
+
+#pragma once
+
+#include "matrix.hpp"
+
+#include <utility>
+#include <vector>
+
+bool find_propagated_move(Matrix& board, const std::vector<std::pair<int, int> >& hints, std::vector<std::pair<int, int> >& mines, std::pair<int, int>& move);
@@ -0,0 +1,64 @@
+#include "rng.hpp"
+
+#include <random>
+
+// One step of SplitMix64: advance by the golden ratio and mix the result.
+static uint64_t mix(uint64_t& state)
+{
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Seeded from the system's entropy source, for when results don't need to be reproduced.
+Rng::Rng() : Rng(random_seed())
+{
+
+}
+
+Rng::Rng(uint64_t seed)
+{
+    this->seed = seed;
+    state = seed;
+}
+
+Rng::~Rng()
+{
+
+}
+
+uint64_t Rng::random_seed()
+{
+    std::random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) | rd();
+}
+
+// Generator for stream index of this seed. Different indices, or the same index of different seeds, give unrelated sequences.
+Rng Rng::stream(uint64_t index) const
+{
+    uint64_t key = seed;
+    uint64_t derived = mix(key);
+    key = derived ^ index;
+    return Rng(mix(key));
+}
+
+uint64_t Rng::next()
+{
+    return mix(state);
+}
+
+// Uniform integer in [0, n). Values from the top of the range that would favour small results are rejected.
+int Rng::uniform(int n)
+{
+    uint64_t bound = static_cast<uint64_t>(n);
+    uint64_t limit = UINT64_MAX - UINT64_MAX % bound;
+    uint64_t value;
+
+    do
+    {
+        value = next();
+    } while(value >= limit);
+
+    return value % bound;
+}
@@ -0,0 +1,31 @@
+/*
+    Small, fast random number generator that can be seeded and split into independent streams.
+
+    The generator is SplitMix64. stream(i) derives a new generator from this one's seed and i, without advancing this one, so a run seeded once can give
+    every game its own stream and still produce the same games no matter which thread plays them or in what order. Numbers are drawn without the
+    standard distributions, whose output differs between standard libraries, so a seed gives the same results on every platform.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+class Rng
+{
+    private:
+
+    uint64_t seed;
+    uint64_t state;
+
+    public:
+
+    Rng();
+    Rng(uint64_t seed);
+    ~Rng();
+
+    static uint64_t random_seed();
+
+    Rng stream(uint64_t index) const;
+    uint64_t next();
+    int uniform(int n);
+};
@@ -0,0 +1,374 @@
+#include "sampler.hpp"
+#include "search.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+MineSampler::MineSampler(Matrix& normalized_board, FrontierComponent& component, int outside_cells, int remaining_mines, const Rng& rng)
+    : normalized_board(normalized_board), component(component), rng(rng)
+{
+    int num_cells = component.fmap.size();
+
+    cell_hints = std::vector<std::vector<int> >(num_cells);
+    hint_cells = std::vector<std::vector<int> >(component.hints.size());
+    hint_partners = std::vector<std::vector<int> >(component.hints.size());
+    hint_needed = std::vector<int>(component.hints.size());
+    hint_mines = std::vector<int>(component.hints.size());
+    hint_slot = std::vector<int>(component.hints.size(), -1);
+    in_block = std::vector<bool>(num_cells);
+
+    for(size_t hint = 0; hint < component.hints.size(); ++hint)
+    {
+        std::pair<int, int> pos = component.hints[hint];
+
+        for(const std::pair<int, int>& index : normalized_board.get_adjacent_indices(pos.first, pos.second))
+        {
+            if(component.fmap.count(index))
+            {
+                int cell = component.fmap(index);
+                hint_cells[hint].push_back(cell);
+                cell_hints[cell].push_back(hint);
+            }
+        }
+        hint_needed[hint] = normalized_board(pos.first, pos.second);
+    }
+
+    for(int cell = 0; cell < num_cells; ++cell)
+    {
+        for(int hint : cell_hints[cell])
+        {
+            for(int partner : cell_hints[cell])
+            {
+                if(partner != hint)
+                {
+                    hint_partners[hint].push_back(partner);
+                }
+            }
+        }
+    }
+    for(std::vector<int>& partners : hint_partners)
+    {
+        std::sort(partners.begin(), partners.end());
+        partners.erase(std::unique(partners.begin(), partners.end()), partners.end());
+    }
+
+    // C(O, R - t), which is 1 for every t too small to use up the mines that don't fit off the frontier. Other components may take those mines.
+    this->remaining_mines = remaining_mines;
+    log_weights = std::vector<double>(num_cells + 1);
+    for(int t = 0; t <= num_cells; ++t)
+    {
+        int rest = remaining_mines - t;
+
+        if(rest < 0)
+        {
+            log_weights[t] = -OVER_PENALTY * -rest;
+        }
+        else if(rest < outside_cells)
+        {
+            log_weights[t] = std::lgamma(outside_cells + 1.0) - std::lgamma(rest + 1.0) - std::lgamma(outside_cells - rest + 1.0);
+        }
+    }
+
+    num_mines = 0;
+    has_deadline = false;
+}
+
+MineSampler::~MineSampler()
+{
+
+}
+
+// A double in [0, 1) from the top 53 bits of the next number.
+double MineSampler::uniform_real()
+{
+    return (rng.next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// List every placement of block[index] onwards that keeps the block's hints satisfiable, given the placement of the cells before it.
+void MineSampler::enumerate(int index, uint32_t mask, int mines)
+{
+    if(index == static_cast<int>(block.size()))
+    {
+        choices.push_back({mask, mines});
+        return;
+    }
+
+    int cell = block[index];
+
+    for(int mine : {0, 1})
+    {
+        bool consistent = true;
+
+        for(int hint : cell_hints[cell])
+        {
+            int slot = hint_slot[hint];
+            --slot_left[slot];
+            slot_needed[slot] -= mine;
+            if(slot_needed[slot] < 0 || slot_needed[slot] > slot_left[slot])
+            {
+                consistent = false;
+            }
+        }
+
+        if(consistent)
+        {
+            enumerate(index + 1, mask | static_cast<uint32_t>(mine) << index, mines + mine);
+        }
+
+        for(int hint : cell_hints[cell])
+        {
+            int slot = hint_slot[hint];
+            ++slot_left[slot];
+            slot_needed[slot] += mine;
+        }
+    }
+}
+
+/*
+    Redraw the cells of a random hint and one of its partners, or on every other step the cells of the hint and all of its partners. The larger blocks
+    make moves that no two hints can make between them. Without them the chain often couldn't reach some of the solutions of small components at all. Partners that would take the block past MAX_BLOCK_CELLS are left out, so the block always fits in the mask.
+*/
+void MineSampler::step()
+{
+    int hint = rng.uniform(hint_cells.size());
+    bool all_partners = rng.uniform(2) == 0;
+
+    picked_hints.clear();
+    picked_hints.push_back(hint);
+    if(all_partners)
+    {
+        picked_hints.insert(picked_hints.end(), hint_partners[hint].begin(), hint_partners[hint].end());
+    }
+    else if(!hint_partners[hint].empty())
+    {
+        picked_hints.push_back(hint_partners[hint][rng.uniform(hint_partners[hint].size())]);
+    }
+
+    block.clear();
+    for(int h : picked_hints)
+    {
+        int new_cells = 0;
+        for(int cell : hint_cells[h])
+        {
+            new_cells += !in_block[cell];
+        }
+        if(static_cast<int>(block.size()) + new_cells > MAX_BLOCK_CELLS)
+        {
+            continue;
+        }
+
+        for(int cell : hint_cells[h])
+        {
+            if(!in_block[cell])
+            {
+                in_block[cell] = true;
+                block.push_back(cell);
+            }
+        }
+    }
+
+    // Each hint around the block needs whatever mines its cells outside the block don't already give it
+    block_hints.clear();
+    slot_needed.clear();
+    slot_left.clear();
+    int block_mines = 0;
+    for(int cell : block)
+    {
+        block_mines += assignment[cell];
+
+        for(int h : cell_hints[cell])
+        {
+            if(hint_slot[h] == -1)
+            {
+                hint_slot[h] = block_hints.size();
+                block_hints.push_back(h);
+                slot_needed.push_back(hint_needed[h] - hint_mines[h]);
+                slot_left.push_back(0);
+            }
+            ++slot_left[hint_slot[h]];
+            slot_needed[hint_slot[h]] += assignment[cell];
+        }
+    }
+
+    // The current placement is always one of the choices, so there is at least one
+    choices.clear();
+    enumerate(0, 0, 0);
+
+    int rest = num_mines - block_mines;
+    double max_log_weight = log_weights[rest + choices[0].second];
+    for(const std::pair<uint32_t, int>& choice : choices)
+    {
+        max_log_weight = std::max(max_log_weight, log_weights[rest + choice.second]);
+    }
+
+    double total_weight = 0.0;
+    for(const std::pair<uint32_t, int>& choice : choices)
+    {
+        total_weight += std::exp(log_weights[rest + choice.second] - max_log_weight);
+    }
+
+    double target = uniform_real() * total_weight;
+    size_t picked = 0;
+    for(; picked + 1 < choices.size(); ++picked)
+    {
+        target -= std::exp(log_weights[rest + choices[picked].second] - max_log_weight);
+        if(target < 0)
+        {
+            break;
+        }
+    }
+
+    for(size_t i = 0; i < block.size(); ++i)
+    {
+        int cell = block[i];
+        bool mine = (choices[picked].first >> i) & 1;
+
+        if(mine != assignment[cell])
+        {
+            assignment[cell] = mine;
+            num_mines += mine ? 1 : -1;
+            for(int h : cell_hints[cell])
+            {
+                hint_mines[h] += mine ? 1 : -1;
+            }
+        }
+        in_block[cell] = false;
+    }
+    for(int h : block_hints)
+    {
+        hint_slot[h] = -1;
+    }
+}
+
+/*
+    Run the chain and add estimated solution counts to solutions. The chain takes steps_per_sample steps between samples, and first runs for an eighth of
+    num_samples samples' worth of steps without keeping any. Returns the number of samples kept, which is less than num_samples if the deadline passed,
+    and 0 if no solution could be found to start from.
+*/
+int MineSampler::sample(int num_samples, int steps_per_sample, SolutionAccumulator& solutions)
+{
+    int num_cells = component.fmap.size();
+    int batch_size = std::max(num_samples / NUM_BATCHES, 1);
+    errors = std::vector<double>(num_cells, 0.5);
+
+    ConstraintSearch search(normalized_board, component, START_NODES);
+    if(!search.find_solution(assignment))
+    {
+        return 0;
+    }
+
+    num_mines = 0;
+    std::fill(hint_mines.begin(), hint_mines.end(), 0);
+    for(int cell = 0; cell < num_cells; ++cell)
+    {
+        num_mines += assignment[cell];
+        for(int hint : cell_hints[cell])
+        {
+            hint_mines[hint] += assignment[cell];
+        }
+    }
+
+    int burn_in = num_samples / 8;
+    SolutionAccumulator samples(num_cells);
+    std::vector<std::vector<double> > batch_mines(NUM_BATCHES, std::vector<double>(num_cells));
+    std::vector<int> batch_samples(NUM_BATCHES);
+    int kept = 0;
+
+    for(int s = -burn_in; s < num_samples; ++s)
+    {
+        if(has_deadline && std::chrono::steady_clock::now() >= deadline)
+        {
+            break;
+        }
+        for(int i = 0; i < steps_per_sample && !hint_cells.empty(); ++i)
+        {
+            step();
+        }
+        if(s < 0)
+        {
+            continue;
+        }
+
+        samples.add(assignment, num_mines);
+        int batch = std::min(kept / batch_size, NUM_BATCHES - 1);
+        for(int cell = 0; cell < num_cells; ++cell)
+        {
+            batch_mines[batch][cell] += assignment[cell];
+        }
+        ++batch_samples[batch];
+        ++kept;
+    }
+
+    if(kept == 0)
+    {
+        return 0;
+    }
+
+    /*
+        Undo the weighting, relative to the heaviest mine count seen so that the totals stay in range. A mine count whose weight is more than
+        MAX_LOG_SCALE below the heaviest would need a scale too large for a double, so it is dropped. Clamping its scale instead would pass its totals
+        on off by the part of the scale that was cut, as if they were exact. Dropping it only loses its share of the samples, and every count that is
+        kept keeps its right weight against the others.
+    */
+    double max_log_weight = -INFINITY;
+    for(size_t t = 0; t < samples.totals.size() && static_cast<int>(t) <= remaining_mines; ++t)
+    {
+        if(samples.totals[t] > 0)
+        {
+            max_log_weight = std::max(max_log_weight, log_weights[t]);
+        }
+    }
+    for(size_t t = 0; t < samples.totals.size(); ++t)
+    {
+        bool in_range = static_cast<int>(t) <= remaining_mines && max_log_weight - log_weights[t] <= MAX_LOG_SCALE;
+        double scale = in_range ? std::exp(max_log_weight - log_weights[t]) : 0.0;
+
+        samples.totals[t] *= scale;
+        for(double& count : samples.cell_mines[t])
+        {
+            count *= scale;
+        }
+    }
+    solutions.merge(samples);
+
+    // Only full batches count, and the last batch takes any samples left over
+    int num_batches = std::min(kept / batch_size, static_cast<int>(NUM_BATCHES));
+    if(num_batches >= 2)
+    {
+        for(int cell = 0; cell < num_cells; ++cell)
+        {
+            double mean = 0.0;
+            double sum_squares = 0.0;
+            for(int b = 0; b < num_batches; ++b)
+            {
+                double p = batch_mines[b][cell] / batch_samples[b];
+                mean += p;
+                sum_squares += p * p;
+            }
+            mean /= num_batches;
+
+            double variance = std::max(sum_squares / num_batches - mean * mean, 0.0) * num_batches / (num_batches - 1);
+            errors[cell] = std::sqrt(variance / num_batches);
+        }
+    }
+
+    return kept;
+}
+
+// Stop sampling once deadline has passed, keeping the samples taken until then.
+void MineSampler::set_deadline(std::chrono::steady_clock::time_point deadline)
+{
+    this->deadline = deadline;
+    has_deadline = true;
+}
+
+int MineSampler::num_hints()
+{
+    return hint_cells.size();
+}
+
+// Standard error of each cell's sampled mine frequency, from the last call to sample. 0.5, the largest it can be, if there were too few samples to tell.
+const std::vector<double>& MineSampler::standard_errors()
+{
+    return errors;
+}
@@ -0,0 +1,82 @@
+/*
+    Markov chain Monte Carlo estimate of the mine placements of a frontier component that is too large to enumerate.
+
+    The chain only ever visits placements that satisfy every hint. Each step picks a hint at random, along with a random hint that shares a cell with it
+    or every hint that does, and redraws the mines in all of their cells at once: every placement of those cells that keeps all the hints around them
+    satisfied is listed, and one of them is picked in proportion to its weight. This is a Gibbs sampler, so once it has run for a while its samples
+    follow that weighting.
+
+    A placement with t mines is weighted by C(O, R - t), the number of ways to put the rest of the remaining mines on the O hidden cells off the frontier,
+    so the chain spends its time on the mine counts that the global mine count makes likely. Dividing each sample by its weight again turns the samples
+    into estimated solution counts per mine count, the same totals a ConstraintSearch leaves in a SolutionAccumulator, so the ProbabilityEngine combines
+    sampled and enumerated components in the same way.
+
+    The chain starts from the first solution a ConstraintSearch finds. Error bars come from batch means: the samples are split into consecutive batches,
+    and the spread of each cell's mine frequency between batches gives its standard error. Redrawing the cells around one hint at a time can't always
+    get from every solution to every other, and on boards where it can't, the samples only cover some of the solutions. The error bars don't show this,
+    beyond a cell that never changes getting an error of 0.
+*/
+
+#pragma once
+
+#include "accumulator.hpp"
+#include "frontier.hpp"
+#include "matrix.hpp"
+#include "rng.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+class MineSampler
+{
+    private:
+
+    static const int NUM_BATCHES = 16;
+    static const int MAX_BLOCK_CELLS = 24;      // Cells redrawn in one step at most. Every placement of them is listed, so this bounds the cost of a step.
+    static const int START_NODES = 100000;      // Node budget for finding the first solution
+    static constexpr double OVER_PENALTY = 50.0;    // Log weight lost per mine over the number remaining, which no solution can have
+    static constexpr double MAX_LOG_SCALE = 700.0;  // Largest log of a scale that undoes a sample's weight, with room left for the sample count
+
+    Matrix& normalized_board;
+    FrontierComponent& component;
+
+    std::vector<std::vector<int> > cell_hints;      // Indices of the hints adjacent to each cell
+    std::vector<std::vector<int> > hint_cells;      // Indices of the cells adjacent to each hint
+    std::vector<std::vector<int> > hint_partners;   // Indices of the other hints that share a cell with each hint
+    std::vector<int> hint_needed;                   // Mines each hint needs among its cells
+    std::vector<int> hint_mines;                    // Mines currently among each hint's cells
+    std::vector<bool> assignment;
+    int num_mines;
+
+    int remaining_mines;
+    std::vector<double> log_weights;                // log_weights[t] is the log of the weight of a placement with t mines
+    Rng rng;
+    bool has_deadline;
+    std::chrono::steady_clock::time_point deadline;
+    std::vector<double> errors;
+
+    // Scratch space for one step
+    std::vector<int> picked_hints;                  // Hints whose cells are redrawn
+    std::vector<int> block;                         // Cells being redrawn
+    std::vector<bool> in_block;
+    std::vector<int> block_hints;                   // Hints adjacent to any of them
+    std::vector<int> hint_slot;                     // Position of each hint in block_hints, or -1
+    std::vector<int> slot_needed;                   // Mines each of those hints still needs from the unassigned block cells
+    std::vector<int> slot_left;                     // Unassigned block cells adjacent to each of those hints
+    std::vector<std::pair<uint32_t, int> > choices; // Each consistent placement of the block as a bit per block cell, and its number of mines
+
+    void step();
+    void enumerate(int index, uint32_t mask, int mines);
+    double uniform_real();
+
+    public:
+
+    MineSampler(Matrix& normalized_board, FrontierComponent& component, int outside_cells, int remaining_mines, const Rng& rng);
+    ~MineSampler();
+
+    int sample(int num_samples, int steps_per_sample, SolutionAccumulator& solutions);
+    void set_deadline(std::chrono::steady_clock::time_point deadline);
+    int num_hints();
+    const std::vector<double>& standard_errors();
+};
@@ -0,0 +1,342 @@
+#include "search.hpp"
+
+#include <algorithm>
+
+ConstraintSearch::ConstraintSearch(Matrix& normalized_board, FrontierComponent& component, int max_nodes)
+{
+    cell_hints = std::vector<std::vector<int> >(component.fmap.size());
+    hint_cells = std::vector<std::vector<int> >(component.hints.size());
+    hint_needed = std::vector<int>(component.hints.size());
+    hint_unassigned = std::vector<int>(component.hints.size());
+    assignment = std::vector<bool>(component.fmap.size());
+    assigned = std::vector<bool>(component.fmap.size());
+
+    for(size_t hint = 0; hint < component.hints.size(); ++hint)
+    {
+        std::pair<int, int> pos = component.hints[hint];
+
+        for(const std::pair<int, int>& index : normalized_board.get_adjacent_indices(pos.first, pos.second))
+        {
+            if(component.fmap.count(index))
+            {
+                int cell = component.fmap(index);
+                hint_cells[hint].push_back(cell);
+                cell_hints[cell].push_back(hint);
+            }
+        }
+        hint_needed[hint] = normalized_board(pos.first, pos.second);
+        hint_unassigned[hint] = hint_cells[hint].size();
+    }
+
+    num_assigned = 0;
+    num_mines = 0;
+    this->max_nodes = max_nodes;
+    nodes = 0;
+    shared_nodes = nullptr;
+    out_of_nodes = false;
+    has_deadline = false;
+    out_of_time = false;
+}
+
+ConstraintSearch::~ConstraintSearch()
+{
+
+}
+
+// Count one more node against the budget, which the subtrees of a split share. Returns false, and counts nothing for this search, if it has run out.
+bool ConstraintSearch::take_node()
+{
+    int total = shared_nodes ? shared_nodes->fetch_add(1, std::memory_order_relaxed) + 1 : nodes + 1;
+    if(total > max_nodes)
+    {
+        out_of_nodes = true;
+        return false;
+    }
+
+    ++nodes;
+    return true;
+}
+
+// Pick an unassigned cell from the hint that is closest to being forced. A hint that needs k of its n unassigned cells to be mines is forced when k is 0 or n.
+int ConstraintSearch::pick_cell()
+{
+    int best_hint = -1;
+    int best_slack = 0;
+
+    for(size_t hint = 0; hint < hint_cells.size(); ++hint)
+    {
+        if(hint_unassigned[hint] == 0)
+        {
+            continue;
+        }
+
+        int slack = std::min(hint_needed[hint], hint_unassigned[hint] - hint_needed[hint]);
+        if(best_hint == -1 || slack < best_slack || (slack == best_slack && hint_unassigned[hint] < hint_unassigned[best_hint]))
+        {
+            best_hint = hint;
+            best_slack = slack;
+        }
+    }
+
+    if(best_hint != -1)
+    {
+        for(int cell : hint_cells[best_hint])
+        {
+            if(!assigned[cell])
+            {
+                return cell;
+            }
+        }
+    }
+
+    // Every frontier cell borders a hint, so this only happens if a hint was left out of the component.
+    for(size_t cell = 0; cell < assigned.size(); ++cell)
+    {
+        if(!assigned[cell])
+        {
+            return cell;
+        }
+    }
+    return -1;
+}
+
+// Assign a value to a cell and update the hints around it. Returns false if any of those hints can no longer be satisfied.
+bool ConstraintSearch::assign(int cell, bool mine)
+{
+    bool consistent = true;
+
+    assignment[cell] = mine;
+    assigned[cell] = true;
+    ++num_assigned;
+    num_mines += mine;
+
+    for(int hint : cell_hints[cell])
+    {
+        --hint_unassigned[hint];
+        if(mine)
+        {
+            --hint_needed[hint];
+        }
+        if(hint_needed[hint] < 0 || hint_needed[hint] > hint_unassigned[hint])
+        {
+            consistent = false;
+        }
+    }
+
+    return consistent;
+}
+
+void ConstraintSearch::unassign(int cell, bool mine)
+{
+    assigned[cell] = false;
+    --num_assigned;
+    num_mines -= mine;
+
+    for(int hint : cell_hints[cell])
+    {
+        ++hint_unassigned[hint];
+        if(mine)
+        {
+            ++hint_needed[hint];
+        }
+    }
+}
+
+void ConstraintSearch::search(SolutionAccumulator& solutions)
+{
+    if(num_assigned == static_cast<int>(assignment.size()))
+    {
+        solutions.add(assignment, num_mines);
+        return;
+    }
+
+    int cell = pick_cell();
+
+    for(bool mine : {false, true})
+    {
+        if(out_of_time)
+        {
+            return;
+        }
+        if(has_deadline && nodes % DEADLINE_CHECK_NODES == 0 && std::chrono::steady_clock::now() >= deadline)
+        {
+            out_of_time = true;
+            return;
+        }
+        if(!take_node())
+        {
+            return;
+        }
+
+        if(assign(cell, mine))
+        {
+            search(solutions);
+        }
+        unassign(cell, mine);
+    }
+}
+
+// Fix assignments the same way search does, counting a node for each the same way, but stop depth levels down and keep a copy of the search at each
+// point reached.
+void ConstraintSearch::expand(int depth, std::vector<ConstraintSearch>& subtrees)
+{
+    if(depth == 0 || num_assigned == static_cast<int>(assignment.size()))
+    {
+        subtrees.push_back(*this);
+        return;
+    }
+
+    int cell = pick_cell();
+
+    for(bool mine : {false, true})
+    {
+        ++nodes;
+        if(assign(cell, mine))
+        {
+            expand(depth - 1, subtrees);
+        }
+        unassign(cell, mine);
+    }
+}
+
+// Search the same way as search, but stop at the first complete placement.
+bool ConstraintSearch::first_solution(std::vector<bool>& solution)
+{
+    if(num_assigned == static_cast<int>(assignment.size()))
+    {
+        solution = assignment;
+        return true;
+    }
+
+    int cell = pick_cell();
+
+    for(bool mine : {false, true})
+    {
+        if(nodes == max_nodes)
+        {
+            out_of_nodes = true;
+            return false;
+        }
+        ++nodes;
+
+        bool found = assign(cell, mine) && first_solution(solution);
+        unassign(cell, mine);
+        if(found)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// A hint that can't be satisfied even before anything is assigned has no solutions.
+bool ConstraintSearch::hints_satisfiable()
+{
+    for(size_t hint = 0; hint < hint_cells.size(); ++hint)
+    {
+        if(hint_needed[hint] < 0 || hint_needed[hint] > hint_unassigned[hint])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Add every placement of mines in the component that satisfies all of its hints to solutions, stopping early if the node budget runs out.
+void ConstraintSearch::solve(SolutionAccumulator& solutions)
+{
+    if(!hints_satisfiable())
+    {
+        return;
+    }
+
+    search(solutions);
+}
+
+/*
+    Split the search into the subtrees left after fixing up to depth assignments, in the order search would visit them. Branches that are already
+    inconsistent are dropped.
+
+    The subtrees keep this search's budget, but count their nodes in node_counter, which starts at the nodes the split took. Between them they can visit
+    as many nodes as this search could have, however those nodes fall between the subtrees. If the split alone went over the budget, every subtree
+    starts out truncated.
+*/
+void ConstraintSearch::split(int depth, std::atomic<int>& node_counter, std::vector<ConstraintSearch>& subtrees)
+{
+    if(!hints_satisfiable())
+    {
+        return;
+    }
+
+    size_t first = subtrees.size();
+    int start_nodes = nodes;
+    expand(depth, subtrees);
+    node_counter = nodes - start_nodes;
+
+    for(size_t i = first; i < subtrees.size(); ++i)
+    {
+        subtrees[i].nodes = 0;
+        subtrees[i].shared_nodes = &node_counter;
+        subtrees[i].out_of_nodes = node_counter > max_nodes;
+        subtrees[i].out_of_time = false;
+    }
+}
+
+/*
+    Fill solutions with an estimate instead of searching, for when there is no time left to search. Each cell is a mine with the mean density of the
+    hints around it, the mines a hint still needs over its cells, and the component counts as a single solution with the expected number of mines.
+*/
+void ConstraintSearch::estimate(SolutionAccumulator& solutions)
+{
+    std::vector<double> probabilities(assignment.size());
+    double expected_mines = 0.0;
+
+    for(size_t cell = 0; cell < assignment.size(); ++cell)
+    {
+        for(int hint : cell_hints[cell])
+        {
+            probabilities[cell] += static_cast<double>(hint_needed[hint]) / hint_cells[hint].size();
+        }
+        if(!cell_hints[cell].empty())
+        {
+            probabilities[cell] = std::min(std::max(probabilities[cell] / cell_hints[cell].size(), 0.0), 1.0);
+        }
+        expected_mines += probabilities[cell];
+    }
+
+    solutions.add_estimate(probabilities, static_cast<int>(expected_mines + 0.5));
+}
+
+// Find one placement of mines that satisfies every hint. Returns false if there is none, or if the node budget runs out before one is found.
+bool ConstraintSearch::find_solution(std::vector<bool>& solution)
+{
+    if(!hints_satisfiable())
+    {
+        return false;
+    }
+
+    return first_solution(solution);
+}
+
+// Stop searching once deadline has passed, as well as when the node budget runs out. Subtrees split off afterwards share the deadline.
+void ConstraintSearch::set_deadline(std::chrono::steady_clock::time_point deadline)
+{
+    this->deadline = deadline;
+    has_deadline = true;
+}
+
+int ConstraintSearch::nodes_visited()
+{
+    return nodes;
+}
+
+// True if the search stopped before visiting every node, for either reason.
+bool ConstraintSearch::truncated()
+{
+    return out_of_nodes || out_of_time;
+}
+
+bool ConstraintSearch::timed_out()
+{
+    return out_of_time;
+}
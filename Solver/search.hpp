@@ -0,0 +1,73 @@
+/*
+    Backtracking search over the mine placements of one frontier component.
+
+    Each hint keeps a running count of the mines it still needs and of its adjacent cells that are still unassigned. A branch is abandoned as soon as
+    some hint needs more mines than it has unassigned cells left, or has been given more mines than its value. The next cell to assign is always taken
+    from the hint with the fewest ways left to satisfy it, so forced cells are assigned first and dead ends are found near the top of the tree.
+    Complete, consistent placements are handed to a SolutionAccumulator as they are found and are never stored.
+
+    A large search can be split into independent subtrees by fixing the first few assignments. Each subtree is a copy of the search that can be solved on
+    its own thread, and together they find exactly the placements the whole search would. The subtrees draw on one node counter, which starts at the
+    nodes the split itself took, so together they run out of nodes exactly when the whole search would: a split search finishes if and only if the
+    search it came from would have, whichever subtrees turn out to be the heavy ones.
+
+    Besides its node budget, a search can be given a deadline. The clock is only read every DEADLINE_CHECK_NODES nodes, so a search may run a little
+    past its deadline, but never by more than that many nodes.
+*/
+
+#pragma once
+
+#include "accumulator.hpp"
+#include "frontier.hpp"
+#include "matrix.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+class ConstraintSearch
+{
+    private:
+
+    static const int DEADLINE_CHECK_NODES = 256;
+
+    std::vector<std::vector<int> > cell_hints;  // Indices of the hints adjacent to each cell
+    std::vector<std::vector<int> > hint_cells;  // Indices of the cells adjacent to each hint
+    std::vector<int> hint_needed;               // Mines each hint still needs
+    std::vector<int> hint_unassigned;           // Unassigned cells adjacent to each hint
+    std::vector<bool> assignment;
+    std::vector<bool> assigned;
+
+    int num_assigned;
+    int num_mines;
+    int max_nodes;
+    int nodes;
+    std::atomic<int>* shared_nodes;             // Nodes taken by every subtree of a split, or null for a search that wasn't split
+    bool out_of_nodes;
+    bool has_deadline;
+    bool out_of_time;
+    std::chrono::steady_clock::time_point deadline;
+
+    bool take_node();
+    int pick_cell();
+    bool assign(int cell, bool mine);
+    void unassign(int cell, bool mine);
+    void search(SolutionAccumulator& solutions);
+    void expand(int depth, std::vector<ConstraintSearch>& subtrees);
+    bool first_solution(std::vector<bool>& solution);
+    bool hints_satisfiable();
+
+    public:
+
+    ConstraintSearch(Matrix& normalized_board, FrontierComponent& component, int max_nodes);
+    ~ConstraintSearch();
+
+    void solve(SolutionAccumulator& solutions);
+    void split(int depth, std::atomic<int>& node_counter, std::vector<ConstraintSearch>& subtrees);
+    void estimate(SolutionAccumulator& solutions);
+    bool find_solution(std::vector<bool>& solution);
+    void set_deadline(std::chrono::steady_clock::time_point deadline);
+    int nodes_visited();
+    bool truncated();
+    bool timed_out();
+};
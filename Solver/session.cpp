@@ -0,0 +1,185 @@
+#include "session.hpp"
+
+#include <map>
+
+SolverSession::SolverSession(Solver& solver, int nrows, int ncols, int num_max_mines) : solver(solver), board(nrows, ncols), hidden_neighbors(nrows, ncols), logic(nrows, ncols)
+{
+    for(int row = 0; row < nrows; ++row)
+    {
+        for(int col = 0; col < ncols; ++col)
+        {
+            board(row, col) = -1;
+            hidden_neighbors(row, col) = board.get_adjacent_indices(row, col).size();
+        }
+    }
+
+    hidden_cells = nrows * ncols;
+    num_known_mines = 0;
+    this->num_max_mines = num_max_mines;
+    heatmap_valid = false;
+}
+
+SolverSession::~SolverSession()
+{
+
+}
+
+// Record that the game revealed the cell at (x, y) with the given hint value.
+void SolverSession::reveal(int x, int y, int hint)
+{
+    if(board(x, y) != -1)
+    {
+        return;
+    }
+
+    NeighborRange neighbors = board.get_adjacent_indices(x, y);
+
+    for(const std::pair<int, int>& index : neighbors)
+    {
+        if(board(index.first, index.second) == -2)
+        {
+            --hint;
+        }
+    }
+    board(x, y) = hint;
+    --hidden_cells;
+    frontier.erase({x, y});
+    heatmap_valid = false;
+
+    for(const std::pair<int, int>& index : neighbors)
+    {
+        --hidden_neighbors(index.first, index.second);
+
+        if(board(index.first, index.second) == -1)
+        {
+            frontier.insert(index);
+        }
+        else if(board(index.first, index.second) >= 0 && hidden_neighbors(index.first, index.second) == 0)
+        {
+            hints.erase(index);
+        }
+    }
+
+    logic.resolve(x, y, 0);
+
+    if(hidden_neighbors(x, y) > 0)
+    {
+        hints.insert({x, y});
+
+        std::vector<std::pair<int, int> > hidden;
+        for(const std::pair<int, int>& index : neighbors)
+        {
+            if(board(index.first, index.second) == -1)
+            {
+                hidden.push_back(index);
+            }
+        }
+        logic.add_row(hidden, hint);
+    }
+}
+
+// The Solver has already marked the cell and normalized its neighbors, so only the bookkeeping is left.
+void SolverSession::mark_mine(int x, int y)
+{
+    --hidden_cells;
+    ++num_known_mines;
+    frontier.erase({x, y});
+    logic.resolve(x, y, 1);
+
+    for(const std::pair<int, int>& index : board.get_adjacent_indices(x, y))
+    {
+        --hidden_neighbors(index.first, index.second);
+
+        if(board(index.first, index.second) >= 0 && hidden_neighbors(index.first, index.second) == 0)
+        {
+            hints.erase(index);
+        }
+    }
+}
+
+FrontierMap SolverSession::frontier_map()
+{
+    FrontierMap fmap;
+    for(const std::pair<int, int>& cell : frontier)
+    {
+        fmap.add(cell.first, cell.second);
+    }
+    return fmap;
+}
+
+// Return the best possible move for the current state of the game.
+std::pair<int, int> SolverSession::best_move()
+{
+    // If probabilities were already worked out for this position, a frontier cell that is at least as safe as any other hidden cell can be taken straight away.
+    if(heatmap_valid && !frontier.empty())
+    {
+        std::pair<int, int> safest = *frontier.begin();
+        for(const std::pair<int, int>& cell : frontier)
+        {
+            if(heatmap[cell.first][cell.second] < heatmap[safest.first][safest.second])
+            {
+                safest = cell;
+            }
+        }
+
+        bool outside_is_safer = false;
+        for(int row = 0; row < board.height && !outside_is_safer; ++row)
+        {
+            for(int col = 0; col < board.width; ++col)
+            {
+                if(board(row, col) == -1 && frontier.count({row, col}) == 0)
+                {
+                    outside_is_safer = heatmap[row][col] < heatmap[safest.first][safest.second];
+                    break;
+                }
+            }
+        }
+        if(!outside_is_safer)
+        {
+            return safest;
+        }
+    }
+
+    return best_move(std::chrono::nanoseconds::zero()).move;
+}
+
+// Return the best move, with how safe it is, giving the Solver time_budget to find it. A zero budget searches with the Solver's usual node limit instead.
+MoveResult SolverSession::best_move(std::chrono::nanoseconds time_budget)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    FrontierMap fmap = frontier_map();
+    std::vector<std::pair<int, int> > hint_cells(hints.begin(), hints.end());
+    std::map<std::pair<int, int>, bool> found_mines;
+
+    // A logic matrix that overflowed is left alone, and the Solver builds it anew each move
+    IncrementalSystem* kept_logic = logic.overflowed() ? nullptr : &logic;
+    MoveResult result = solver.best_move(board, fmap, hint_cells, hidden_cells, num_known_mines, num_max_mines, found_mines, time_budget, kept_logic, start);
+
+    for(auto it = found_mines.begin(); it != found_mines.end(); ++it)
+    {
+        mark_mine(it->first.first, it->first.second);
+    }
+
+    return result;
+}
+
+// Return the probability of each cell being a mine, computing it only if something was revealed since the last call.
+const std::vector<std::vector<double> >& SolverSession::mine_probabilities()
+{
+    if(!heatmap_valid)
+    {
+        FrontierMap fmap = frontier_map();
+        std::vector<std::pair<int, int> > hint_cells(hints.begin(), hints.end());
+        std::map<std::pair<int, int>, bool> found_mines;
+
+        heatmap = solver.mine_probabilities(board, fmap, hint_cells, hidden_cells, num_known_mines, num_max_mines, found_mines);
+
+        for(auto it = found_mines.begin(); it != found_mines.end(); ++it)
+        {
+            mark_mine(it->first.first, it->first.second);
+        }
+        heatmap_valid = true;
+    }
+
+    return heatmap;
+}
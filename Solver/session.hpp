@@ -0,0 +1,58 @@
+/*
+    A SolverSession follows a single game from start to finish. Instead of handing the Solver the whole board every move, the game reports each
+    cell it reveals, and the session keeps the board, the frontier, the hint cells bordering the frontier, the known mines and the number of hidden
+    cells up to date as it goes. The work done per reveal is proportional to the number of cells around it, not to the size of the board.
+
+    The logic matrix is kept the same way. Each reveal adds the new hint's row and takes the revealed cell's column out, and each mine the Solver finds
+    takes its column out, so the Solver only has to look at the rows that changed instead of building and eliminating the matrix every move.
+
+    Mine probabilities are cached until the next reveal, so asking for them again, or asking for a move after them, does not redo the enumeration.
+
+    The Solver is borrowed rather than owned, so one Solver can serve every game a thread plays.
+
+    The session's board is kept normalized: cells known to be mines are marked -2 and every hint has the number of its known adjacent mines subtracted.
+*/
+
+#pragma once
+
+#include "frontier.hpp"
+#include "incremental.hpp"
+#include "matrix.hpp"
+#include "solver.hpp"
+
+#include <chrono>
+#include <set>
+#include <utility>
+#include <vector>
+
+class SolverSession
+{
+    private:
+
+    Solver& solver;
+    Matrix board;
+    Matrix hidden_neighbors;                        // Number of adjacent cells still marked -1
+    std::set<std::pair<int, int> > frontier;        // Hidden cells adjacent to a revealed cell
+    std::set<std::pair<int, int> > hints;           // Revealed cells adjacent to a hidden cell
+    IncrementalSystem logic;                        // The logic matrix of the hints, kept eliminated
+
+    int hidden_cells;
+    int num_known_mines;
+    int num_max_mines;
+
+    std::vector<std::vector<double> > heatmap;      // Mine probabilities, kept until the next reveal
+    bool heatmap_valid;
+
+    void mark_mine(int x, int y);
+    FrontierMap frontier_map();
+
+    public:
+
+    SolverSession(Solver& solver, int nrows, int ncols, int num_max_mines);
+    ~SolverSession();
+
+    void reveal(int x, int y, int hint);
+    std::pair<int, int> best_move();
+    MoveResult best_move(std::chrono::nanoseconds time_budget);
+    const std::vector<std::vector<double> >& mine_probabilities();
+};
@@ -1,50 +1,32 @@
 #include "solver.hpp"
 
+#include "component_cache.hpp"
 #include "matrix.hpp"
+#include "patterns.hpp"
+#include "propagation.hpp"
+#include "probability.hpp"
+#include "sampler.hpp"
+#include "search.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <map>
-#include <random>
 #include <utility>
 #include <vector>
 
 #include <iostream>
 
-
-int Solver::count_nonzero_hints(Matrix& board)
+// Nanoseconds elapsed since start.
+static long long elapsed_ns(std::chrono::steady_clock::time_point start)
 {
-    int count = 0;
-
-    for(int row = 0; row < board.height; ++row)
-    {
-        for(int col = 0; col < board.width; ++col)
-        {
-            if(board(row, col) > 0)
-            {
-                ++count;
-            }
-        }
-    }
-
-    return count;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
 }
 
-int Solver::count_hidden_cells(Matrix& board)
+int Solver::count_hidden_cells(BoardBits& bits)
 {
-    int count = 0;
-
-    for(int row = 0; row < board.height; ++row)
-    {
-        for(int col = 0; col < board.width; ++col)
-        {
-            if(board(row, col) == -1)
-            {
-                ++count;
-            }
-        }
-    }
-
-    return count;
+    return bits.hidden.count();
 }
 
 // Use known mine locations and mark cells accordingly. Then subtract 1 from hint cells adjacent to those mines.
@@ -54,8 +36,7 @@ void Solver::normalize_board(Matrix& board, std::map<std::pair<int, int>, bool>&
     {
         board(it->first.first, it->first.second) = -2;
 
-        std::vector<std::pair<int, int> > adjacent_indecies = board.get_adjacent_indices(it->first.first, it->first.second);
-        for(std::pair<int, int> index : adjacent_indecies)
+        for(const std::pair<int, int>& index : board.get_adjacent_indices(it->first.first, it->first.second))
         {
             if(board(index.first, index.second) > 0)
             {
@@ -65,124 +46,94 @@ void Solver::normalize_board(Matrix& board, std::map<std::pair<int, int>, bool>&
     }
 }
 
+// Find every revealed cell that has at least one hidden neighbor, in row-major order.
+std::vector<std::pair<int, int> > Solver::collect_hints(BoardBits& bits)
+{
+    return (bits.revealed & bits.hidden.neighbors(bits.cells)).positions();
+}
+
 /*
-    Each column of the logic matrix, except for the last, correlates to a frontier cell. The integers in the last column are the values of the hint cells which those frontier cells are
-    adjacent to. These correlations are kept track of with a FrontierMap.
+    Each column of the logic matrix correlates to a frontier cell, and each row to a hint cell with the hint's value on the right hand side. These
+    correlations are kept track of with a FrontierMap. The matrix is kept sparse, since each row only has the few frontier cells around one hint.
 */
-Matrix Solver::construct_logic_matrix(Matrix& board, FrontierMap& fmap)
+SparseSystem Solver::construct_logic_matrix(Matrix& board, FrontierMap& fmap, const std::vector<std::pair<int, int> >& hints)
 {
-    int count = 0;
-    Matrix unsolved_matrix(count_nonzero_hints(board), fmap.size()+1);
+    SparseSystem unsolved_system(fmap.size());
+    std::vector<int> cols;
 
-    for(int row = 0; row < board.height; ++row)
+    for(const std::pair<int, int>& hint : hints)
     {
-        for(int col = 0; col < board.width; ++col)
+        //If this cell is a hint
+        if(board(hint.first, hint.second) > 0)
         {
-            //If this cell is a hint
-			if (board(row, col) > 0)
-			{
-				bool onFringe = false;
-				//Find all adjacent cells that are fringe cells related to this hint
-                		std::vector<std::pair<int, int> > adjacent_indices = board.get_adjacent_indices(row, col);
-				for(std::pair<int, int> index : adjacent_indices)
-                		{
-                    			//If adjacent cell is "unknown"
-                    			if(board(index.first, index.second) == -1)
-                    			{
-                        			onFringe = true;
-                        			std::pair<int, int> pos(index.first, index.second);
-						unsolved_matrix(count, fmap(pos)) = 1;
-                    			}
-               			}
-				if (onFringe)
-				{
-					unsolved_matrix(count++, unsolved_matrix.width - 1) = board(row, col);
-				}
-			}
-        }
-    }
-
-    return unsolved_matrix;
+            //Find all adjacent cells that are fringe cells related to this hint
+            cols.clear();
+            for(const std::pair<int, int>& index : board.get_adjacent_indices(hint.first, hint.second))
+            {
+                //If adjacent cell is "unknown"
+                if(board(index.first, index.second) == -1)
+                {
+                    cols.push_back(fmap(index));
+                }
+            }
+            unsolved_system.add_row(cols, board(hint.first, hint.second));
+        }
+    }
+
+    return unsolved_system;
 }
 
 // Find if there is a move that is guarenteed to be safe.
-bool Solver::find_guaranteed_move(Matrix& board, Matrix& unsolved_logic_matrix, Matrix& solved_logic_matrix, FrontierMap& fmap, std::map<std::pair<int, int>, bool>& known_mines, std::pair<int, int>& move)
+bool Solver::find_guaranteed_move(SparseSystem& unsolved_system, SparseSystem& solved_system, FrontierMap& fmap, std::map<std::pair<int, int>, bool>& known_mines, std::pair<int, int>& move)
 {
-    // Go through each row of the solved_logic_matrix
-    for(int row = 0; row < solved_logic_matrix.height; ++row)
+    // Go through each row of the solved_system
+    for(int row = 0; row < solved_system.height(); ++row)
     {
         int col;
 
-        if((col = solved_logic_matrix.is_lonely_row(row)) != -1)
+        if((col = solved_system.is_lonely_row(row)) != -1)
         {
-            if(solved_logic_matrix(row, solved_logic_matrix.width - 1) == 0)
+            if(solved_system.value(row) == 0)
             {
                 move = fmap(col);
                 return true;
             }
-            else if(solved_logic_matrix(row, solved_logic_matrix.width - 1) == 1)
+            else if(solved_system.value(row) == 1)
             {
                 known_mines[fmap(col)] = true;
             }
         }
-        else if(solved_logic_matrix.is_safe_row(row))
+        else if(solved_system.is_safe_row(row))
         {
-            for(int i = 0; i < solved_logic_matrix.width - 1; ++i)
-            {
-                if(solved_logic_matrix(row, i) == 1)
-                {
-                    move = fmap(i);
-                    return true;
-                }
-            }
+            move = fmap(solved_system.row(row)[0].col);
+            return true;
         }
     }
 
     // Check to see if there are hint cells that have the same number of adjacent hidden cells as their hint value. In theses cases, all hidden cells adjacent to the hint cell are mines.
-    for(int row = 0; row < unsolved_logic_matrix.height; ++row)
+    for(int row = 0; row < unsolved_system.height(); ++row)
     {
-        if(unsolved_logic_matrix(row, unsolved_logic_matrix.width - 1) > 0)
+        if(unsolved_system.value(row) > 0 && unsolved_system.row(row).size() == unsolved_system.value(row))
         {
-            int count = 0;
-            for(int col = 0; col < unsolved_logic_matrix.width - 1; ++col)
-            {
-                if(unsolved_logic_matrix(row, col) != 0)
-                {
-                    ++count;
-                }
-            }
-            if(count == unsolved_logic_matrix(row, unsolved_logic_matrix.width - 1))
+            for(const SparseSystem::Entry& entry : unsolved_system.row(row))
             {
-                for(int col = 0; col < unsolved_logic_matrix.width - 1; ++col)
-                {
-                    if(unsolved_logic_matrix(row, col) != 0)
-                    {
-                        known_mines[fmap(col)] = true;
-                    }
-                }
+                known_mines[fmap(entry.col)] = true;
             }
         }
     }
 
-    // We have found the locations of some mines, so use that to see if we can now find a guarenteed safe cell.
-    normalize_board(board, known_mines);
-
-    return find_move_from_normalized_board(board, move);
+    return false;
 }
 
 // Pick any random cell that is hidden as our move.
 std::pair<int, int> Solver::random_move(Matrix& normalized_board)
 {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> row_rand(0, normalized_board.height - 1);
-    std::uniform_int_distribution<int> col_rand(0, normalized_board.width - 1);
     int row, col;
 
     while(1)
     {
-        row = row_rand(gen);
-        col = col_rand(gen);
+        row = rng.uniform(normalized_board.height);
+        col = rng.uniform(normalized_board.width);
 
         if(normalized_board(row, col) == -1)
         {
@@ -192,281 +143,886 @@ std::pair<int, int> Solver::random_move(Matrix& normalized_board)
     return {0, 0};
 }
 
-// Calculate the probability that k mines exist within the n frontier cells, given p probability of a cell being a mine.
-double Solver::binomial_pmf(int n, int k, int p)
+// Pick a random hidden cell that is not on the frontier as our move.
+std::pair<int, int> Solver::random_outside_move(Matrix& normalized_board, FrontierMap& fmap)
 {
-    auto binomial_coeff = [&n, &k](){
-        double result = 1;
-        for(int i = 1; i <= k; ++i)
+    int row, col;
+
+    while(1)
+    {
+        row = rng.uniform(normalized_board.height);
+        col = rng.uniform(normalized_board.width);
+
+        if(normalized_board(row, col) == -1 && fmap.count(std::pair<int, int>(row, col)) == 0)
         {
-            result *= (n + 1 - i) / i;
+            return {row, col};
         }
-        return result;
+    }
+    return {0, 0};
+}
+
+// Split the frontier into groups of cells that do not share any hint cells. Each group can then be enumerated on its own.
+std::vector<FrontierComponent> Solver::split_frontier(Matrix& normalized_board, FrontierMap& normalized_fmap, const std::vector<std::pair<int, int> >& hints)
+{
+    std::vector<int> parent(normalized_fmap.size());
+    for(size_t i = 0; i < parent.size(); ++i)
+    {
+        parent[i] = i;
+    }
+
+    auto find = [&parent](int col) -> int {
+        while(parent[col] != col)
+        {
+            col = parent[col] = parent[parent[col]];
+        }
+        return col;
     };
 
-    return binomial_coeff() * std::pow(p, k) * std::pow((1 - p), (n - k));
+    // Any two hidden cells around the same hint end up in the same component
+    std::vector<std::pair<std::pair<int, int>, int> > constraining_hints;
+    for(const std::pair<int, int>& hint : hints)
+    {
+        if(normalized_board(hint.first, hint.second) < 0)
+        {
+            continue;
+        }
+
+        int first = -1;
+        for(const std::pair<int, int>& index : normalized_board.get_adjacent_indices(hint.first, hint.second))
+        {
+            if(normalized_board(index.first, index.second) == -1)
+            {
+                int root = find(normalized_fmap(index));
+                if(first == -1)
+                {
+                    first = root;
+                }
+                else
+                {
+                    parent[root] = find(first);
+                }
+            }
+        }
+        if(first != -1)
+        {
+            constraining_hints.push_back({hint, first});
+        }
+    }
+
+    std::vector<FrontierComponent> components;
+    std::map<int, int> root_to_component;
+
+    for(int col = 0; col < normalized_fmap.size(); ++col)
+    {
+        int root = find(col);
+        if(root_to_component.count(root) == 0)
+        {
+            root_to_component[root] = components.size();
+            components.emplace_back();
+        }
+        std::pair<int, int> pos = normalized_fmap(col);
+        components[root_to_component[root]].fmap.add(pos.first, pos.second);
+    }
+
+    for(std::pair<std::pair<int, int>, int>& hint : constraining_hints)
+    {
+        components[root_to_component[find(hint.second)]].hints.push_back(hint.first);
+    }
+
+    return components;
 }
 
-// Given a combination, return how many mines are present.
-int Solver::count_num_mines_in_combo(std::vector<bool> &combo)
+// Generate all possible combinations of mines in one component of the frontier, keeping only per-mine-count totals. Returns false if the search stopped early.
+bool Solver::generate_combinations(Matrix& normalized_board, FrontierComponent& component, int max_nodes, SolutionAccumulator& solutions)
 {
-    int count = 0;
-    for(size_t i = 0; i < combo.size(); ++i)
+    bool finished;
+    if(num_threads > 1 && component.fmap.size() >= PARALLEL_MIN_CELLS)
     {
-        if(combo[i] == true)
+        finished = generate_combinations_parallel(normalized_board, component, max_nodes, solutions);
+    }
+    else
+    {
+        ConstraintSearch search(normalized_board, component, max_nodes);
+        if(has_deadline)
         {
-            count++;
+            search.set_deadline(deadline);
         }
+        search.solve(solutions);
+
+        profile.search_nodes += search.nodes_visited();
+        finished = !search.truncated();
+    }
+
+    // Counted here rather than by the fallbacks, since a capped search that sampling then rescues leaves no other trace
+    profile.capped_searches += !finished;
+    return finished;
+}
+
+/*
+    Search one large component on the thread pool. The search is split into subtrees by fixing its first few assignments, and the subtrees are shared out
+    between the workers, each of which counts its solutions into an accumulator of its own. The subtrees draw on one shared node counter, so the parallel
+    search finishes exactly when the sequential one would, however unevenly the nodes fall between the subtrees. Solution counts are whole numbers, so
+    merging the workers' accumulators is exact in any order, and a finished search counts the same solutions for any number of threads.
+
+    Which placements a truncated search has counted depends on how the workers raced for the last nodes. Without a deadline those partial counts may be
+    used, so the component is searched again on this thread to get the same partial counts as a single thread would. With a deadline they are discarded.
+*/
+bool Solver::generate_combinations_parallel(Matrix& normalized_board, FrontierComponent& component, int max_nodes, SolutionAccumulator& solutions)
+{
+    int depth = 0;
+    while((1 << depth) < num_threads * SUBTREES_PER_THREAD)
+    {
+        ++depth;
+    }
+
+    std::vector<ConstraintSearch> subtrees;
+    std::atomic<int> shared_nodes(0);
+    ConstraintSearch search(normalized_board, component, max_nodes);
+    if(has_deadline)
+    {
+        search.set_deadline(deadline);
+    }
+    search.split(depth, shared_nodes, subtrees);
+
+    std::vector<SolutionAccumulator> worker_solutions(pool->size(), SolutionAccumulator(component.fmap.size()));
+    for(ConstraintSearch& subtree : subtrees)
+    {
+        pool->submit([&subtree, &worker_solutions](int worker) -> void {
+            subtree.solve(worker_solutions[worker]);
+        });
+    }
+    pool->wait();
+
+    bool complete = true;
+    profile.search_nodes += search.nodes_visited();
+    for(ConstraintSearch& subtree : subtrees)
+    {
+        profile.search_nodes += subtree.nodes_visited();
+        complete = complete && !subtree.truncated();
+    }
+
+    if(!complete && !has_deadline)
+    {
+        ConstraintSearch sequential(normalized_board, component, max_nodes);
+        sequential.solve(solutions);
+        profile.search_nodes += sequential.nodes_visited();
+        return false;
+    }
+
+    for(SolutionAccumulator& partial : worker_solutions)
+    {
+        solutions.merge(partial);
+    }
+    return complete;
+}
+
+/*
+    Estimate the placements of a component by sampling, for components too large to enumerate. Fills errors with the standard error of each cell's sampled
+    frequency. Returns false if the sampler could not find a placement to start from, or ran out of time before taking any samples.
+*/
+bool Solver::sample_combinations(Matrix& normalized_board, FrontierComponent& component, int outside_cells, int remaining_mines, SolutionAccumulator& solutions, std::vector<double>& errors)
+{
+    MineSampler sampler(normalized_board, component, outside_cells, remaining_mines, Rng(rng.next()));
+    if(has_deadline)
+    {
+        sampler.set_deadline(deadline);
+    }
+
+    if(sampler.sample(NUM_SAMPLES, std::max(sampler.num_hints() / 2, 1), solutions) == 0)
+    {
+        return false;
     }
-    return count;
+
+    errors = sampler.standard_errors();
+    return true;
 }
 
-// Count the how many combinations contain certain numbers of mines.
-std::map<int, int> Solver::count_combinations(std::vector<std::vector<bool> >& combinations)
+/*
+    Search every component with the time left before the deadline, rather than with a fixed node budget. The searches go in rounds: every component not yet
+    finished is searched from scratch with the round's node budget, which doubles from one round to the next up to MAX_COMBO_DEPTH. Small components finish
+    in the first round or two, so a single huge component can't take the time the others need. Repeating a search costs at most as much again as its last
+    round.
+
+    Components that are still not finished after the last round, and components too large to try, are sampled with whatever time is left. Any that
+    can't be sampled in time get an estimate from their hints instead of their partial counts, since a partial count is biased towards the placements the
+    search tries first.
+
+    finished says which components already have their solutions, and is updated with the ones whose search finishes.
+*/
+void Solver::generate_combinations_by_deadline(Matrix& normalized_board, std::vector<FrontierComponent>& components, int outside_cells, int remaining_mines, std::vector<SolutionAccumulator>& component_solutions, std::vector<bool>& finished)
 {
-    int mine_count_in_combo;
-    std::map<int, int> combo_counts;
+    for(int max_nodes = DEADLINE_FIRST_NODES; std::chrono::steady_clock::now() < deadline; max_nodes *= 2)
+    {
+        max_nodes = std::min(max_nodes, MAX_COMBO_DEPTH);
+
+        for(size_t c = 0; c < components.size() && std::chrono::steady_clock::now() < deadline; ++c)
+        {
+            if(finished[c] || components[c].fmap.size() >= SAMPLE_MIN_CELLS)
+            {
+                continue;
+            }
+
+            SolutionAccumulator solutions(components[c].fmap.size());
+            if(generate_combinations(normalized_board, components[c], max_nodes, solutions))
+            {
+                component_solutions[c] = solutions;
+                finished[c] = true;
+            }
+        }
+
+        if(max_nodes == MAX_COMBO_DEPTH || std::find(finished.begin(), finished.end(), false) == finished.end())
+        {
+            break;
+        }
+    }
 
-    for(std::vector<bool>& combo : combinations)
+    for(size_t c = 0; c < components.size(); ++c)
     {
-        mine_count_in_combo = count_num_mines_in_combo(combo);
+        if(finished[c])
+        {
+            continue;
+        }
 
-        if(combo_counts.count(mine_count_in_combo) == 0)
+        SolutionAccumulator solutions(components[c].fmap.size());
+        if(std::chrono::steady_clock::now() < deadline && sample_combinations(normalized_board, components[c], outside_cells, remaining_mines, solutions, sample_errors[c]))
         {
-            combo_counts[mine_count_in_combo] = 1;
+            ++profile.sampled_components;
         }
         else
         {
-            combo_counts[mine_count_in_combo] += 1;
+            ConstraintSearch(normalized_board, components[c], 0).estimate(solutions);
+            ++profile.estimated_components;
+        }
+        component_solutions[c] = solutions;
+    }
+}
+
+// After the board is normalized, a safe move may now be apparent. Check for hint cells of value 0. Any adjacent hidden cells must be safe.
+bool Solver::find_move_from_normalized_board(Matrix& normalized_board, const std::vector<std::pair<int, int> >& hints, std::pair<int, int>& move)
+{
+    for(const std::pair<int, int>& hint : hints)
+    {
+        // If this cell has a hint value of 0
+        if(normalized_board(hint.first, hint.second) == 0)
+        {
+            // Check all adjacent cells
+            for(const std::pair<int, int>& index : normalized_board.get_adjacent_indices(hint.first, hint.second))
+            {
+                // If the adjacent cell is hidden, then it must be safe
+                if(normalized_board(index.first, index.second) == -1)
+                {
+                    move = index;
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+
+// Normalizing only turns frontier cells into mines, so the normalized frontier is the old one without them.
+FrontierMap Solver::normalize_frontier(FrontierMap& fmap, std::map<std::pair<int, int>, bool>& known_mines)
+{
+    FrontierMap normalized_fmap;
+
+    for(int col = 0; col < fmap.size(); ++col)
+    {
+        if(known_mines.count(fmap(col)) == 0)
+        {
+            normalized_fmap.add(fmap(col).first, fmap(col).second);
         }
     }
 
-    return combo_counts;
+    return normalized_fmap;
 }
 
-// A combination is valid if it satisfies the constraints given by the hint cells.
-bool Solver::is_valid_combination(Matrix& normalized_board, FrontierMap& normalized_fmap, std::vector<bool>& combo)
+/*
+    Work out the exact probability of every frontier cell being a mine, along with the probability for cells off the frontier.
+
+    The frontier is first split into components that share no hint cells. Each component's combinations are generated on their own and tallied by the number
+    of mines they contain. The ProbabilityEngine then weights every combination by the number of ways the rest of the mines can be placed and combines the
+    components. Returns false if the combinations found are inconsistent with the number of remaining mines.
+*/
+bool Solver::compute_probabilities(Matrix& normalized_board, FrontierMap& normalized_fmap, const std::vector<std::pair<int, int> >& hints, int remaining_cells, int remaining_mines, std::vector<FrontierComponent>& components)
 {
-    Matrix temp_board(normalized_board);
+    components = split_frontier(normalized_board, normalized_fmap, hints);
+    std::vector<SolutionAccumulator> component_solutions;
 
-    for(size_t i = 0; i < combo.size(); ++i)
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(FrontierComponent& component : components)
     {
-        if(combo[i] == true)
+        component_solutions.push_back(SolutionAccumulator(component.fmap.size()));
+        profile.largest_component = std::max(profile.largest_component, component.fmap.size());
+    }
+    profile.components = components.size();
+
+    sample_errors = std::vector<std::vector<double> >(components.size());
+    int outside_cells = remaining_cells - normalized_fmap.size();
+
+    // Components that this Solver, or any other sharing its cache, has already searched are taken from the cache
+    std::vector<CanonicalComponent> canonical(components.size());
+    std::vector<bool> cached(components.size());
+    std::vector<bool> solved(components.size());
+    for(size_t c = 0; cache && c < components.size(); ++c)
+    {
+        if(components[c].fmap.size() <= CACHE_MAX_CELLS)
         {
-            temp_board(normalized_fmap(i).first, normalized_fmap(i).second) = -2;
+            canonical[c] = ComponentCache::canonicalize(normalized_board, components[c]);
+            cached[c] = solved[c] = cache->lookup(canonical[c], component_solutions[c]);
+            profile.cached_components += cached[c];
         }
     }
 
-    for(int row = 0; row < temp_board.height; ++row)
+    if(has_deadline)
+    {
+        generate_combinations_by_deadline(normalized_board, components, outside_cells, remaining_mines, component_solutions, solved);
+    }
+    else
     {
-        for(int col = 0; col < temp_board.width; ++col)
+        // Components that are too large to enumerate, or turn out to be, are sampled instead. If sampling fails, a truncated search is still better than nothing.
+        for(size_t c = 0; c < components.size(); ++c)
         {
-            if(temp_board(row, col) > 0)
+            if(solved[c])
             {
-                int count = 0;
-                std::vector<std::pair<int, int> > adjacent_indices = temp_board.get_adjacent_indices(row, col);
-                for(std::pair<int, int>& index : adjacent_indices)
-                {
-                    if(temp_board(index.first, index.second) == -2)
-                    {
-                        count++;
-                    }
-                }
-                if(count != temp_board(row, col))
-                {
-                    return false;
-                }
+                continue;
+            }
+
+            bool large = components[c].fmap.size() >= SAMPLE_MIN_CELLS;
+            if(!large && generate_combinations(normalized_board, components[c], MAX_COMBO_DEPTH, component_solutions[c]))
+            {
+                solved[c] = true;
+                continue;
+            }
+
+            SolutionAccumulator solutions(components[c].fmap.size());
+            if(sample_combinations(normalized_board, components[c], outside_cells, remaining_mines, solutions, sample_errors[c]))
+            {
+                component_solutions[c] = solutions;
+                ++profile.sampled_components;
+            }
+            else if(large)
+            {
+                ConstraintSearch(normalized_board, components[c], 0).estimate(component_solutions[c]);
+                ++profile.estimated_components;
+            }
+            else
+            {
+                ++profile.truncated_components;
             }
         }
     }
 
-    return true;
+    // Only exact counts are cached. Sampled, estimated and truncated ones would be passed off as exact by every later lookup.
+    for(size_t c = 0; c < components.size(); ++c)
+    {
+        if(solved[c] && !cached[c] && !canonical[c].key.empty())
+        {
+            cache->insert(canonical[c], component_solutions[c]);
+        }
+    }
+    profile.combinations_ns = elapsed_ns(start);
+
+    return probability_engine.solve(component_solutions, outside_cells, remaining_mines);
 }
 
-void Solver::generate_combinations_recursive(Matrix& normalized_board, std::vector<std::vector<bool> >& combinations, std::vector<bool>& combo, FrontierMap& normalized_fmap, size_t pos)
+/*
+    There are no guarenteed safe moves, so use probability to find a move that has the highest chance of being safe.
+
+    The frontier cell with the lowest probability of being a mine is picked, unless a cell off the frontier is less likely to be a mine, in which case a random
+    one of those is picked. If the probabilities can't be computed, just pick any random cell as our move.
+*/
+void Solver::find_safest_move(Matrix& normalized_board, FrontierMap& fmap, const std::vector<std::pair<int, int> >& hints, std::map<std::pair<int, int>, bool>& known_mines, int hidden_cells, int num_known_mines, std::pair<int, int>& move, int num_max_mines)
 {
+    FrontierMap normalized_fmap = normalize_frontier(fmap, known_mines);
+    std::vector<FrontierComponent> components;
 
-    if(depth_counter == MAX_COMBO_DEPTH)
+    int remaining_mines = num_max_mines - num_known_mines - known_mines.size();
+    int remaining_cells = hidden_cells - known_mines.size();
+
+    if(!compute_probabilities(normalized_board, normalized_fmap, hints, remaining_cells, remaining_mines, components))
     {
+        move = random_move(normalized_board);
+        result.probability = static_cast<double>(remaining_mines) / remaining_cells;
+        result.confidence = CONFIDENCE_NONE;
         return;
     }
-    depth_counter++;
 
-    if(pos == combo.size())
+    double lowest_probability = 2.0;
+    for(size_t c = 0; c < components.size(); ++c)
     {
-        if(is_valid_combination(normalized_board, normalized_fmap, combo))
+        for(int cell = 0; cell < components[c].fmap.size(); ++cell)
         {
-            combinations.push_back(combo);
+            if(probability_engine.cell_probabilities[c][cell] < lowest_probability)
+            {
+                lowest_probability = probability_engine.cell_probabilities[c][cell];
+                move = components[c].fmap(cell);
+                result.error = sample_errors[c].empty() ? 0.0 : sample_errors[c][cell];
+            }
         }
-        return;
     }
 
-    combo[pos] = false;
-    generate_combinations_recursive(normalized_board, combinations, combo, normalized_fmap, pos+1);
+    if(remaining_cells > normalized_fmap.size() && probability_engine.outside_probability < lowest_probability)
+    {
+        move = random_outside_move(normalized_board, normalized_fmap);
+        lowest_probability = probability_engine.outside_probability;
+        result.error = 0.0;
+    }
 
-    combo[pos] = true;
-    generate_combinations_recursive(normalized_board, combinations, combo, normalized_fmap, pos+1);
+    result.probability = lowest_probability;
+    result.confidence = CONFIDENCE_EXACT;
+    if(profile.sampled_components > 0)
+    {
+        result.confidence = CONFIDENCE_SAMPLED;
+    }
+    if(profile.truncated_components > 0)
+    {
+        result.confidence = CONFIDENCE_PARTIAL;
+    }
+    if(profile.estimated_components > 0)
+    {
+        result.confidence = CONFIDENCE_ESTIMATED;
+    }
 }
 
-// Generate all possible combinations of mines in the frontier.
-std::vector<std::vector<bool> > Solver::generate_combinations(Matrix& normalized_board, FrontierMap& normalized_fmap)
+// Fill a board-sized heatmap with the probability of each cell being a mine. Revealed cells are 0 and known mines are 1.
+std::vector<std::vector<double> > Solver::mine_probabilities(Matrix& board, FrontierMap& fmap, const std::vector<std::pair<int, int> >& hints, int hidden_cells, int num_known_mines, int num_max_mines, std::map<std::pair<int, int>, bool>& known_mines)
 {
-    std::vector<std::vector<bool> > combinations;
-    std::vector<bool> combo(normalized_fmap.size());
-    depth_counter = 0;
-    generate_combinations_recursive(normalized_board, combinations, combo, normalized_fmap, 0);
-    return combinations;
-}
+    std::vector<std::vector<double> > heatmap(board.height, std::vector<double>(board.width));
+    std::pair<int, int> move;
+    has_deadline = false;
 
-// After the board is normalized, a safe move may now be apparent. Check for hint cells of value 0. Any adjacent hidden cells must be safe.
-bool Solver::find_move_from_normalized_board(Matrix& normalized_board, std::pair<int, int>& move)
-{
-    for(int row = 0; row < normalized_board.height; ++row)
+    // Mines that the logic matrix can prove leave fewer cells to enumerate.
+    SparseSystem unsolved_system = construct_logic_matrix(board, fmap, hints);
+    SparseSystem solved_system(unsolved_system);
+    if(solved_system.eliminate())
+    {
+        find_guaranteed_move(unsolved_system, solved_system, fmap, known_mines, move);
+    }
+    normalize_board(board, known_mines);
+
+    FrontierMap normalized_fmap = normalize_frontier(fmap, known_mines);
+    std::vector<FrontierComponent> components;
+
+    int remaining_mines = num_max_mines - num_known_mines - known_mines.size();
+    int remaining_cells = hidden_cells - known_mines.size();
+    bool solved = compute_probabilities(board, normalized_fmap, hints, remaining_cells, remaining_mines, components);
+
+    for(int row = 0; row < board.height; ++row)
     {
-        for(int col = 0; col < normalized_board.width; ++col)
+        for(int col = 0; col < board.width; ++col)
         {
-            // If this cell has a hint value of 0
-            if(normalized_board(row, col) == 0)
+            if(board(row, col) == -2)
             {
-                // Check all adjacent cells
-                for(std::pair<int, int>& index : normalized_board.get_adjacent_indices(row, col))
-                {
-                    // If the adjacent cell is hidden, then it must be safe
-                    if(normalized_board(index.first, index.second) == -1)
-                    {
-                        move = index;
-                        return true;
-                    }
-                }
+                heatmap[row][col] = 1.0;
+            }
+            else if(board(row, col) == -1)
+            {
+                heatmap[row][col] = solved ? probability_engine.outside_probability : static_cast<double>(remaining_mines) / remaining_cells;
             }
         }
     }
-    return false;
+
+    if(solved)
+    {
+        for(size_t c = 0; c < components.size(); ++c)
+        {
+            for(int cell = 0; cell < components[c].fmap.size(); ++cell)
+            {
+                std::pair<int, int> pos = components[c].fmap(cell);
+                heatmap[pos.first][pos.second] = probability_engine.cell_probabilities[c][cell];
+            }
+        }
+    }
+
+    return heatmap;
 }
 
+std::vector<std::vector<double> > Solver::mine_probabilities(std::vector<std::vector<int> > grid, int num_max_mines)
+{
+    Matrix board(grid);
+    BoardBits bits(board);
+    FrontierMap fmap(bits.frontier());
+    std::vector<std::pair<int, int> > hints = collect_hints(bits);
+    std::map<std::pair<int, int>, bool> known_mines;
 
-/*
-    There are no guarenteed safe moves, so use probability to find a move that has the highest chance of being safe.
+    return mine_probabilities(board, fmap, hints, count_hidden_cells(bits), 0, num_max_mines, known_mines);
+}
 
-    First, calculate the probabilites of the frontier having certain amounts of mines using the binomial distribution. Then see how many combinations contain those amounts of mines.
-    If many combinations exist that have a certain amount of mines, then the probability of that number of mines occuring in the frontier is split between those combinations. 
+// Check to see if this is the first move for the game.
+bool Solver::is_first_move(Matrix& board, int hidden_cells)
+{
+    return hidden_cells == board.width * board.height;
+}
 
-    Then we see whether there is a combination that has a higher chance of being true than the probability of any random cell being a mine. If there is, then we assume that combination to be true
-    and we pick a safe cell from it. If not, then just pick any random cell as our move.
-*/
-void Solver::find_safest_move(Matrix& normalized_board, FrontierMap& fmap, std::map<std::pair<int, int>, bool>& known_mines, std::pair<int, int>& move, int num_max_mines)
+// Return the best possible move for the given board.
+std::pair<int, int> Solver::best_move(std::vector<std::vector<int> > grid, int num_max_mines)
 {
-    int remaining_mines;
-    int remaining_cells;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    Matrix board(grid);
+    BoardBits bits(board);
+    FrontierMap fmap(bits.frontier());
+    std::vector<std::pair<int, int> > hints = collect_hints(bits);
+    std::map<std::pair<int, int>, bool> known_mines;
+
+    return best_move(board, fmap, hints, count_hidden_cells(bits), 0, num_max_mines, known_mines, std::chrono::nanoseconds::zero(), nullptr, start).move;
+}
+
+// Return the best move for the given board within time_budget, see the other best_move with a time budget.
+MoveResult Solver::best_move(std::vector<std::vector<int> > grid, int num_max_mines, std::chrono::nanoseconds time_budget)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    Matrix board(grid);
+    BoardBits bits(board);
+    FrontierMap fmap(bits.frontier());
+    std::vector<std::pair<int, int> > hints = collect_hints(bits);
+    std::map<std::pair<int, int>, bool> known_mines;
+
+    return best_move(board, fmap, hints, count_hidden_cells(bits), 0, num_max_mines, known_mines, time_budget, nullptr, start);
+}
 
-    FrontierMap normalized_fmap(normalized_board);
+/*
+    Return the best move for every board in the batch.
 
-    remaining_mines = num_max_mines - known_mines.size();
-    remaining_cells = count_hidden_cells(normalized_board);
+    The cheap deductions are made for all of the boards at once, one cell at a time with the boards in the inner loop: a hint with as many hidden
+    neighbors as its value makes all of them mines, and a hint that already touches as many of those mines as its value makes the rest of its hidden
+    neighbors safe. Every board where that finds a safe cell gets the first one in row-major order, which may not be the same guaranteed safe cell that
+    best_move would pick. Only the boards that are left go through best_move one at a time.
+*/
+std::vector<std::pair<int, int> > Solver::best_moves(BoardBatch& batch, int num_max_mines)
+{
+    int num_boards = batch.num_boards;
+    int num_cells = batch.nrows * batch.ncols;
+    const BoardGeometry& geometry = BoardGeometry::get(batch.nrows, batch.ncols);
 
-    double generic_mine_probability = remaining_mines / remaining_cells;
-    std::vector<std::vector<bool> > combinations = generate_combinations(normalized_board, normalized_fmap);
-    std::map<int, int> combo_counts = count_combinations(combinations);
-    std::vector<double> probabilities_for_num_mines;
+    std::vector<int> hidden_cells(num_boards);
+    std::vector<int> move_cell(num_boards, -1);
+    std::vector<int8_t> hidden_adjacent(num_cells * num_boards);
+    std::vector<int8_t> rule(num_cells * num_boards);           // Hints whose hidden neighbors are all mines, then hints whose unknown neighbors are all safe
+    std::vector<int8_t> mine(num_cells * num_boards);
+    std::vector<int8_t> mines_adjacent(num_cells * num_boards);
 
-    // Calculate how likely it is for the frontier to contain various amounts of mines
-    for(auto it = combo_counts.begin(); it != combo_counts.end(); ++it)
+    for(int cell = 0; cell < num_cells; ++cell)
     {
-        probabilities_for_num_mines.push_back(binomial_pmf(fmap.size(), it->first, generic_mine_probability));
-    }
+        const int8_t* value = batch.lane(cell / batch.ncols, cell % batch.ncols);
+        int8_t* count = &hidden_adjacent[cell * num_boards];
 
-    // Normalize the probabilites amongst themselves, so that they add up to 100%
-    double probability_total = 0.0;
+        for(int board = 0; board < num_boards; ++board)
+        {
+            hidden_cells[board] += value[board] == -1;
+        }
+        for(const std::pair<int, int>& neighbor : geometry.adjacent(cell / batch.ncols, cell % batch.ncols))
+        {
+            const int8_t* neighbor_value = batch.lane(neighbor.first, neighbor.second);
+            for(int board = 0; board < num_boards; ++board)
+            {
+                count[board] += neighbor_value[board] == -1;
+            }
+        }
+    }
 
-    for(double &prob : probabilities_for_num_mines)
+    for(int cell = 0; cell < num_cells; ++cell)
     {
-        probability_total += prob;
+        const int8_t* value = batch.lane(cell / batch.ncols, cell % batch.ncols);
+        const int8_t* count = &hidden_adjacent[cell * num_boards];
+        int8_t* full = &rule[cell * num_boards];
+
+        for(int board = 0; board < num_boards; ++board)
+        {
+            full[board] = value[board] > 0 && value[board] == count[board];
+        }
     }
 
-    for(double &prob : probabilities_for_num_mines)
+    for(int cell = 0; cell < num_cells; ++cell)
     {
-        prob /= probability_total;
+        const int8_t* value = batch.lane(cell / batch.ncols, cell % batch.ncols);
+        int8_t* is_mine = &mine[cell * num_boards];
+
+        for(const std::pair<int, int>& neighbor : geometry.adjacent(cell / batch.ncols, cell % batch.ncols))
+        {
+            int index = neighbor.first * batch.ncols + neighbor.second;
+            const int8_t* full = &rule[index * num_boards];
+            for(int board = 0; board < num_boards; ++board)
+            {
+                is_mine[board] |= full[board];
+            }
+        }
+        for(int board = 0; board < num_boards; ++board)
+        {
+            is_mine[board] &= value[board] == -1;
+        }
     }
 
-    double predicted_num_mines_inside_frontier = 0.0;
-    int counter = 0;
-    for(auto it = combo_counts.begin(); it != combo_counts.end(); ++it)
+    for(int cell = 0; cell < num_cells; ++cell)
     {
-        predicted_num_mines_inside_frontier += it->first * probabilities_for_num_mines[counter++];
+        const int8_t* value = batch.lane(cell / batch.ncols, cell % batch.ncols);
+        const int8_t* count = &hidden_adjacent[cell * num_boards];
+        int8_t* mines = &mines_adjacent[cell * num_boards];
+        int8_t* satisfied = &rule[cell * num_boards];
+
+        for(const std::pair<int, int>& neighbor : geometry.adjacent(cell / batch.ncols, cell % batch.ncols))
+        {
+            int index = neighbor.first * batch.ncols + neighbor.second;
+            const int8_t* is_mine = &mine[index * num_boards];
+            for(int board = 0; board < num_boards; ++board)
+            {
+                mines[board] += is_mine[board];
+            }
+        }
+        for(int board = 0; board < num_boards; ++board)
+        {
+            satisfied[board] = value[board] >= 0 && mines[board] == value[board] && count[board] > mines[board];
+        }
     }
-    double probability_for_mine_outside_frontier = (remaining_mines - predicted_num_mines_inside_frontier) / (remaining_cells - normalized_fmap.size());
 
-    // Check the probability of each combo occuring
-    for(auto it = combo_counts.begin(); it != combo_counts.end(); ++it)
+    std::vector<int8_t> safe(num_boards);
+    for(int cell = num_cells - 1; cell >= 0; --cell)
     {
-        counter = 0;
-        // If this combination has a greater chance of occuring than the probability of a random outside cell being a mine, pick it
-        if(probabilities_for_num_mines[counter++] / it->second >= probability_for_mine_outside_frontier)
+        const int8_t* value = batch.lane(cell / batch.ncols, cell % batch.ncols);
+        const int8_t* is_mine = &mine[cell * num_boards];
+
+        std::fill(safe.begin(), safe.end(), 0);
+        for(const std::pair<int, int>& neighbor : geometry.adjacent(cell / batch.ncols, cell % batch.ncols))
         {
-            // Find a safe cell within the combination
-            for(std::vector<bool>& combo : combinations)
+            int index = neighbor.first * batch.ncols + neighbor.second;
+            const int8_t* satisfied = &rule[index * num_boards];
+            for(int board = 0; board < num_boards; ++board)
             {
-                if(count_num_mines_in_combo(combo) == it->first)
-                {
-                    for(size_t i = 0; i < combo.size(); ++i)
-                    {
-                        if(combo[i] == false)
-                        {
-                            move = normalized_fmap(i);
-                            return;
-                        }
-                    }
-                }
+                safe[board] |= satisfied[board];
             }
         }
+        // Cells are visited last to first, so the move left at the end is the first safe cell.
+        for(int board = 0; board < num_boards; ++board)
+        {
+            move_cell[board] = safe[board] && value[board] == -1 && !is_mine[board] ? cell : move_cell[board];
+        }
     }
-    move = random_move(normalized_board);
-}
 
-// Check to see if this is the first move for the game.
-bool Solver::is_first_move(Matrix& board)
-{
-    for(int row = 0; row < board.height; ++row)
+    std::vector<std::pair<int, int> > moves(num_boards);
+    for(int board = 0; board < num_boards; ++board)
     {
-        for(int col = 0; col < board.width; ++col)
+        if(hidden_cells[board] == num_cells)
+        {
+            moves[board] = {0, 0};
+        }
+        else if(move_cell[board] != -1)
+        {
+            moves[board] = {move_cell[board] / batch.ncols, move_cell[board] % batch.ncols};
+        }
+        else
         {
-            if(board(row, col) != -1)
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            Matrix board_matrix(batch.nrows, batch.ncols);
+            for(int row = 0; row < batch.nrows; ++row)
             {
-                return false;
+                for(int col = 0; col < batch.ncols; ++col)
+                {
+                    board_matrix(row, col) = batch(board, row, col);
+                }
             }
+
+            BoardBits bits(board_matrix);
+            FrontierMap fmap(bits.frontier());
+            std::vector<std::pair<int, int> > hints = collect_hints(bits);
+            std::map<std::pair<int, int>, bool> known_mines;
+
+            moves[board] = best_move(board_matrix, fmap, hints, hidden_cells[board], 0, num_max_mines, known_mines, std::chrono::nanoseconds::zero(), nullptr, start).move;
         }
     }
 
-    return true;
+    return moves;
 }
 
-// Return the best possible move for the given board.
-std::pair<int, int> Solver::best_move(std::vector<std::vector<int> > grid, int num_max_mines)
+// Return the best possible move given state that the caller already keeps up to date. Mines found along the way are normalized into board and added to known_mines.
+std::pair<int, int> Solver::best_move(Matrix& board, FrontierMap& fmap, const std::vector<std::pair<int, int> >& hints, int hidden_cells, int num_known_mines, int num_max_mines, std::map<std::pair<int, int>, bool>& known_mines)
+{
+    return best_move(board, fmap, hints, hidden_cells, num_known_mines, num_max_mines, known_mines, std::chrono::nanoseconds::zero()).move;
+}
+
+/*
+    The same as best_move, but also say how safe the move is and how far that can be trusted. If time_budget is not zero, the search for probabilities
+    runs until time_budget has passed since the call started, instead of until each component has used MAX_COMBO_DEPTH nodes, and components it could not
+    finish in time are estimated. Everything before the search takes time proportional to the size of the board, so the call as a whole only overruns
+    the budget by that much.
+*/
+MoveResult Solver::best_move(Matrix& board, FrontierMap& fmap, const std::vector<std::pair<int, int> >& hints, int hidden_cells, int num_known_mines, int num_max_mines, std::map<std::pair<int, int>, bool>& known_mines, std::chrono::nanoseconds time_budget)
+{
+    return best_move(board, fmap, hints, hidden_cells, num_known_mines, num_max_mines, known_mines, time_budget, nullptr, std::chrono::steady_clock::now());
+}
+
+/*
+    The same as best_move, but with the logic matrix already eliminated in logic, which the caller has kept up to date with the board, instead of built
+    anew. logic may be null.
+
+    start is when the caller started on the call, before it built board, fmap and hints. total_ns and the time budget both count from there, so the
+    profile that is recorded covers the caller's setup as well.
+*/
+MoveResult Solver::best_move(Matrix& board, FrontierMap& fmap, const std::vector<std::pair<int, int> >& hints, int hidden_cells, int num_known_mines, int num_max_mines, std::map<std::pair<int, int>, bool>& known_mines, std::chrono::nanoseconds time_budget, IncrementalSystem* logic, std::chrono::steady_clock::time_point start)
 {
     std::pair<int, int> move(-1, -1);
 
-    Matrix board(grid);
+    profile = SolverProfile();
+    profile.frontier_cells = fmap.size();
+    result = MoveResult{move, 0.0, 0.0, CONFIDENCE_CERTAIN};
+    has_deadline = time_budget > std::chrono::nanoseconds::zero();
+    deadline = start + time_budget;
 
-    // If this is the first move of the game, just pick the top-left cell.
-    if(is_first_move(board))
+    // If this is the first move of the game, just pick the top-left cell. The game never puts a mine under the first move.
+    if(is_first_move(board, hidden_cells))
     {
-        return {0, 0};
+        finish_profile(start, SOURCE_FIRST_MOVE);
+        result.move = {0, 0};
+        return result;
     }
 
-    FrontierMap fmap(board);
-    std::map<std::pair<int, int>, bool> known_mines;
-    Matrix unsolved_logic_matrix = construct_logic_matrix(board, fmap);
-    Matrix solved_logic_matrix(unsolved_logic_matrix);
-    solved_logic_matrix.rref();
+    // Most safe cells can be found by looking at one hint at a time, which is much cheaper than building and solving the logic matrix.
+    std::chrono::steady_clock::time_point phase_start = std::chrono::steady_clock::now();
+    std::vector<std::pair<int, int> > trivial_mines;
+    bool trivial = find_trivial_move(board, hints, trivial_mines, move);
+    profile.trivial_ns = elapsed_ns(phase_start);
+
+    if(trivial)
+    {
+        for(const std::pair<int, int>& mine : trivial_mines)
+        {
+            known_mines[mine] = true;
+        }
+        normalize_board(board, known_mines);
+
+        finish_profile(start, SOURCE_TRIVIAL);
+        result.move = move;
+        return result;
+    }
 
-    //unsolved_logic_matrix.print();
-    //solved_logic_matrix.print();
+    // Next, pairs of hints. The pattern table has every deduction they can make worked out already.
+    phase_start = std::chrono::steady_clock::now();
+    std::vector<std::pair<int, int> > pattern_mines;
+    bool pattern = find_pattern_move(board, hints, pattern_mines, move);
+    profile.pattern_ns = elapsed_ns(phase_start);
 
-    if(!find_guaranteed_move(board, unsolved_logic_matrix, solved_logic_matrix, fmap, known_mines, move))
+    if(pattern)
     {
-     
-        find_safest_move(board, fmap, known_mines, move, num_max_mines);
+        for(const std::pair<int, int>& mine : pattern_mines)
+        {
+            known_mines[mine] = true;
+        }
+        normalize_board(board, known_mines);
+
+        finish_profile(start, SOURCE_PATTERN);
+        result.move = move;
+        return result;
+    }
+
+    // Then chains of hints, propagated until nothing more follows from them
+    phase_start = std::chrono::steady_clock::now();
+    std::vector<std::pair<int, int> > propagated_mines;
+    bool propagated = find_propagated_move(board, hints, propagated_mines, move);
+    profile.propagation_ns = elapsed_ns(phase_start);
+
+    if(propagated)
+    {
+        for(const std::pair<int, int>& mine : propagated_mines)
+        {
+            known_mines[mine] = true;
+        }
+        normalize_board(board, known_mines);
+
+        finish_profile(start, SOURCE_PROPAGATION);
+        result.move = move;
+        return result;
+    }
+
+    bool found;
+    if(logic)
+    {
+        // Only the rows that changed since the last move need looking at
+        phase_start = std::chrono::steady_clock::now();
+        std::vector<std::pair<int, int> > logic_mines;
+        found = logic->find_move(logic_mines, move);
+        for(const std::pair<int, int>& mine : logic_mines)
+        {
+            known_mines[mine] = true;
+        }
+        profile.guaranteed_ns = elapsed_ns(phase_start);
+        profile.logic_rows = logic->height();
+        profile.logic_cols = logic->width();
+    }
+    else
+    {
+        phase_start = std::chrono::steady_clock::now();
+        SparseSystem unsolved_system = construct_logic_matrix(board, fmap, hints);
+        SparseSystem solved_system(unsolved_system);
+        profile.logic_matrix_ns = elapsed_ns(phase_start);
+        profile.logic_rows = unsolved_system.height();
+        profile.logic_cols = unsolved_system.width();
+
+        phase_start = std::chrono::steady_clock::now();
+        bool exact = solved_system.eliminate();
+        profile.eliminate_ns = elapsed_ns(phase_start);
+
+        // A system that overflowed says nothing, and the later tiers still find a move
+        phase_start = std::chrono::steady_clock::now();
+        found = exact && find_guaranteed_move(unsolved_system, solved_system, fmap, known_mines, move);
+        profile.guaranteed_ns = elapsed_ns(phase_start);
     }
 
-    return move;
+    // We have found the locations of some mines, so use that to see if we can now find a guarenteed safe cell.
+    normalize_board(board, known_mines);
+
+    MoveSource source = found ? SOURCE_GUARANTEED : SOURCE_NORMALIZED;
+    if(!found && !find_move_from_normalized_board(board, hints, move))
+    {
+        source = SOURCE_SAFEST;
+        phase_start = std::chrono::steady_clock::now();
+        find_safest_move(board, fmap, hints, known_mines, hidden_cells, num_known_mines, move, num_max_mines);
+        profile.safest_ns = elapsed_ns(phase_start);
+    }
+
+    finish_profile(start, source);
+    result.move = move;
+    return result;
+}
+
+// Close off the profile of a best_move call, and hand it to the attached SolverMetrics if there is one.
+void Solver::finish_profile(std::chrono::steady_clock::time_point start, MoveSource source)
+{
+    profile.total_ns = elapsed_ns(start);
+    profile.source = source;
+
+    if(metrics)
+    {
+        metrics->record(profile);
+    }
+}
+
+const SolverProfile& Solver::last_profile()
+{
+    return profile;
+}
+
+// Record every best_move call from now on into metrics, or stop recording if it is null. The Solver does not own it.
+void Solver::set_metrics(SolverMetrics* metrics)
+{
+    this->metrics = metrics;
+}
+
+// Use rng for the random moves made from now on. Seeding a Solver per game makes its moves reproducible.
+void Solver::set_rng(const Rng& rng)
+{
+    this->rng = rng;
+}
+
+// Share solved components through cache from now on, or stop caching them if it is null. The Solver does not own it.
+void Solver::set_cache(ComponentCache* cache)
+{
+    this->cache = cache;
+}
+
+// Search large frontier components with n threads. Starts or replaces the thread pool, so don't call this while a move is being worked out.
+void Solver::set_num_threads(int n)
+{
+    num_threads = n;
+    pool.reset(n > 1 ? new WorkStealingPool(n) : nullptr);
 }
@@ -4,47 +4,119 @@
     The Solver first finds cells that constitute the "frontier" of a given board. These are hidden cells that are adjacent to a hint cell. A matrix is then constructed representing the relationship
     between these frontier cells and their adjacent hint cells. Computing the rref of this matrix gives information on the location of safe and mine cells in the frontier. If a safe cell is located for a given state
     it is picked as the move for the round. If not, a copy of the board is made, and known mine locations that were computed earlier are marked. If these markings reveal the location of a safe cell, then that is picked.
-    If there still is no guarenteed safe cell, the solver computes the probabiities of cells along the frontier having mines in them. This is done by generating all possible combinations of mine placements. The probability
+    If there still is no guarenteed safe cell, the solver computes the probabiities of cells along the frontier having mines in them. This is done by generating all possible combinations of mine placements and weighting each by the number of ways the remaining mines can be placed off the frontier. The probability
     that a cell outside the frontier contains a mine is also calculated. If it is found that there is a higher chance of one of the frontier cells containing a mine, then a random outside cell is picked. Otherwise the frontier cell
     with the least likely probability of containing a mine is picked.
 */
 
 #pragma once
 
+#include "accumulator.hpp"
+#include "batch.hpp"
+#include "component_cache.hpp"
 #include "frontier.hpp"
+#include "incremental.hpp"
+#include "kernels.hpp"
 #include "matrix.hpp"
+#include "metrics.hpp"
+#include "probability.hpp"
+#include "rng.hpp"
+#include "search.hpp"
+#include "sparse.hpp"
+#include "thread_pool.hpp"
 
+#include <chrono>
+#include <cstddef>
 #include <map>
+#include <memory>
 #include <utility>
 #include <vector>
 
+// How much a move returned by best_move can be trusted.
+enum MoveConfidence
+{
+    CONFIDENCE_CERTAIN,     // The move is known to be safe
+    CONFIDENCE_EXACT,       // probability is exact
+    CONFIDENCE_SAMPLED,     // Some component was too large to enumerate and was sampled, and error is the standard error of the move's probability
+    CONFIDENCE_PARTIAL,     // Some component's search ran out of nodes, so probability only counts the placements it reached
+    CONFIDENCE_ESTIMATED,   // The deadline passed before some component's search finished, so its probabilities were estimated from its hints
+    CONFIDENCE_NONE         // Probabilities could not be computed, and the move is a random hidden cell
+};
+
+struct MoveResult
+{
+    std::pair<int, int> move;
+    double probability;         // Chance that move is a mine
+    double error;               // Standard error of probability, 0 unless the move's own probability was sampled
+    MoveConfidence confidence;
+};
+
 class Solver
 {
     private:
 
-    const int MAX_COMBO_DEPTH = 60000; // Limit how many combinations are generated. Higher = more time, but higher chance of success.
-    int depth_counter;
+    const int MAX_COMBO_DEPTH = 60000; // Limit how many search nodes are visited per component. Higher = more time, but higher chance of success.
+    SolverProfile profile;
+    SolverMetrics* metrics = nullptr;
+    MoveResult result;
+
+    const int DEADLINE_FIRST_NODES = 1024;  // Node budget of the first round of searches under a deadline. Each round after that doubles it.
+    bool has_deadline = false;
+    std::chrono::steady_clock::time_point deadline;
+
+    const int SAMPLE_MIN_CELLS = 200;   // Components at least this large are sampled without trying to enumerate them first.
+    const int NUM_SAMPLES = 2000;
+    std::vector<std::vector<double> > sample_errors;    // Standard errors for each cell of each sampled component, empty for the others
+    ProbabilityEngine probability_engine;
 
-    int count_nonzero_hints(Matrix& board);
-    int count_hidden_cells(Matrix& board);
+    const int CACHE_MAX_CELLS = 48;     // Larger components seldom come up twice, and would take up too much of the cache.
+    ComponentCache* cache = &ComponentCache::shared();
+    Rng rng;
+
+    const int PARALLEL_MIN_CELLS = 24;  // Components with fewer cells than this are always searched on one thread.
+    const int SUBTREES_PER_THREAD = 8;  // Split large components finely enough that stealing can even out subtrees of very different sizes.
+    int num_threads = 1;
+    std::unique_ptr<WorkStealingPool> pool;
+
+    int count_hidden_cells(BoardBits& bits);
+    std::vector<std::pair<int, int> > collect_hints(BoardBits& bits);
     void normalize_board(Matrix& board, std::map<std::pair<int, int>, bool>& known_mines);
-    Matrix construct_logic_matrix(Matrix& board, FrontierMap& fmap);
-    bool find_guaranteed_move(Matrix& board, Matrix& unsolved_logic_matrix, Matrix& solved_logic_matrix, FrontierMap& fmap, std::map<std::pair<int, int>, bool>& known_mines, std::pair<int, int>&  move);
+    SparseSystem construct_logic_matrix(Matrix& board, FrontierMap& fmap, const std::vector<std::pair<int, int> >& hints);
+    bool find_guaranteed_move(SparseSystem& unsolved_system, SparseSystem& solved_system, FrontierMap& fmap, std::map<std::pair<int, int>, bool>& known_mines, std::pair<int, int>&  move);
     
     std::pair<int, int> random_move(Matrix& normalized_board);
-    double binomial_pmf(int n, int k, int p);
-    int count_num_mines_in_combo(std::vector<bool> &combo);
-    std::map<int, int> count_combinations(std::vector<std::vector<bool> >& combinations);
-    bool is_valid_combination(Matrix& normalized_board, FrontierMap& normalized_fmap, std::vector<bool>& combo);
-    void generate_combinations_recursive(Matrix& normalized_board, std::vector<std::vector<bool> >& combinations, std::vector<bool>& combo, FrontierMap& normalized_fmap, size_t pos);
-    std::vector<std::vector<bool> > generate_combinations(Matrix& normalized_board, FrontierMap& normalized_fmap);
+    std::pair<int, int> random_outside_move(Matrix& normalized_board, FrontierMap& fmap);
+    std::vector<FrontierComponent> split_frontier(Matrix& normalized_board, FrontierMap& normalized_fmap, const std::vector<std::pair<int, int> >& hints);
+    bool generate_combinations(Matrix& normalized_board, FrontierComponent& component, int max_nodes, SolutionAccumulator& solutions);
+    bool generate_combinations_parallel(Matrix& normalized_board, FrontierComponent& component, int max_nodes, SolutionAccumulator& solutions);
+    bool sample_combinations(Matrix& normalized_board, FrontierComponent& component, int outside_cells, int remaining_mines, SolutionAccumulator& solutions, std::vector<double>& errors);
+    void generate_combinations_by_deadline(Matrix& normalized_board, std::vector<FrontierComponent>& components, int outside_cells, int remaining_mines, std::vector<SolutionAccumulator>& component_solutions, std::vector<bool>& finished);
+
+    FrontierMap normalize_frontier(FrontierMap& fmap, std::map<std::pair<int, int>, bool>& known_mines);
+    bool compute_probabilities(Matrix& normalized_board, FrontierMap& normalized_fmap, const std::vector<std::pair<int, int> >& hints, int remaining_cells, int remaining_mines, std::vector<FrontierComponent>& components);
 
-    bool find_move_from_normalized_board(Matrix& normalized_board, std::pair<int, int>& move);
-    void find_safest_move(Matrix& normalized_board, FrontierMap& fmap, std::map<std::pair<int, int>, bool>& known_mines, std::pair<int, int>& move, int num_max_mines);
+    bool find_move_from_normalized_board(Matrix& normalized_board, const std::vector<std::pair<int, int> >& hints, std::pair<int, int>& move);
+    void find_safest_move(Matrix& normalized_board, FrontierMap& fmap, const std::vector<std::pair<int, int> >& hints, std::map<std::pair<int, int>, bool>& known_mines, int hidden_cells, int num_known_mines, std::pair<int, int>& move, int num_max_mines);
 
-    bool is_first_move(Matrix& board);
+    bool is_first_move(Matrix& board, int hidden_cells);
+    void finish_profile(std::chrono::steady_clock::time_point start, MoveSource source);
 
     public:
     
     std::pair<int, int> best_move(std::vector<std::vector<int> > grid, int um_max_mines);
+    std::pair<int, int> best_move(Matrix& board, FrontierMap& fmap, const std::vector<std::pair<int, int> >& hints, int hidden_cells, int num_known_mines, int num_max_mines, std::map<std::pair<int, int>, bool>& known_mines);
+    MoveResult best_move(std::vector<std::vector<int> > grid, int num_max_mines, std::chrono::nanoseconds time_budget);
+    MoveResult best_move(Matrix& board, FrontierMap& fmap, const std::vector<std::pair<int, int> >& hints, int hidden_cells, int num_known_mines, int num_max_mines, std::map<std::pair<int, int>, bool>& known_mines, std::chrono::nanoseconds time_budget);
+    MoveResult best_move(Matrix& board, FrontierMap& fmap, const std::vector<std::pair<int, int> >& hints, int hidden_cells, int num_known_mines, int num_max_mines, std::map<std::pair<int, int>, bool>& known_mines, std::chrono::nanoseconds time_budget, IncrementalSystem* logic, std::chrono::steady_clock::time_point start);
+
+    std::vector<std::pair<int, int> > best_moves(BoardBatch& batch, int num_max_mines);
+
+    std::vector<std::vector<double> > mine_probabilities(std::vector<std::vector<int> > grid, int num_max_mines);
+    std::vector<std::vector<double> > mine_probabilities(Matrix& board, FrontierMap& fmap, const std::vector<std::pair<int, int> >& hints, int hidden_cells, int num_known_mines, int num_max_mines, std::map<std::pair<int, int>, bool>& known_mines);
+
+    const SolverProfile& last_profile();
+    void set_metrics(SolverMetrics* metrics);
+    void set_cache(ComponentCache* cache);
+    void set_num_threads(int n);
+    void set_rng(const Rng& rng);
 };
\ No newline at end of file
@@ -0,0 +1,327 @@
+#include "sparse.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+#include <utility>
+
+const int SparseSystem::MAX_COL_COUNT;
+
+SparseSystem::SparseSystem(int num_cols) : num_cols(num_cols)
+{
+    overflow = false;
+}
+
+SparseSystem::~SparseSystem()
+{
+
+}
+
+// Add the row for a hint with value mines among the cells in cols. Every coefficient is 1.
+void SparseSystem::add_row(const std::vector<int>& cols, int value)
+{
+    Span span{static_cast<int>(pool.size()), static_cast<int>(cols.size()), static_cast<int>(cols.size()), false};
+
+    for(int col : cols)
+    {
+        pool.push_back({col, 1});
+    }
+    std::sort(pool.begin() + span.start, pool.end(), [](const Entry& a, const Entry& b) -> bool {
+        return a.col < b.col;
+    });
+
+    spans.push_back(span);
+    values.push_back(value);
+}
+
+int SparseSystem::coefficient(int row, int col)
+{
+    EntryRange entries = this->row(row);
+    const Entry* it = std::lower_bound(entries.begin(), entries.end(), col, [](const Entry& entry, int c) -> bool {
+        return entry.col < c;
+    });
+    return it != entries.end() && it->col == col ? it->value : 0;
+}
+
+void SparseSystem::link(int col, int row)
+{
+    links.push_back({row, col_head[col]});
+    col_head[col] = links.size() - 1;
+}
+
+/*
+    Clear col from row with pivot, as row = a * row - b * pivot where a and b are their coefficients in col. Merges the two sorted runs in one pass.
+
+    The new row is worked out in 64 bits and divided by its gcd before it is stored. If it still has an entry bigger than MAX_ENTRY, the row is left as
+    it was and overflow is set, since the system can no longer be trusted.
+*/
+void SparseSystem::clear_column(int row, int pivot, int col)
+{
+    long long a = coefficient(pivot, col);
+    long long b = coefficient(row, col);
+    EntryRange r = this->row(row);
+    EntryRange p = this->row(pivot);
+
+    wide.clear();
+    const Entry* i = r.begin();
+    const Entry* k = p.begin();
+    while(i != r.end() || k != p.end())
+    {
+        long long entry;
+        int c;
+
+        if(k == p.end() || (i != r.end() && i->col < k->col))
+        {
+            c = i->col;
+            entry = a * (i++)->value;
+        }
+        else if(i == r.end() || k->col < i->col)
+        {
+            c = k->col;
+            entry = -b * (k++)->value;
+            link(c, row);       // Fill-in
+        }
+        else
+        {
+            c = i->col;
+            entry = a * (i++)->value - b * (k++)->value;
+        }
+
+        if(entry != 0)
+        {
+            wide.push_back({c, entry});
+        }
+    }
+
+    long long value = a * values[row] - b * values[pivot];
+    long long divisor = std::abs(value);
+    for(auto entry = wide.begin(); entry != wide.end() && divisor != 1; ++entry)
+    {
+        divisor = std::gcd(divisor, std::abs(entry->value));
+    }
+    divisor = std::max(divisor, 1LL);
+
+    if(std::abs(value / divisor) > MAX_ENTRY)
+    {
+        overflow = true;
+        return;
+    }
+    scratch.clear();
+    for(const WideEntry& entry : wide)
+    {
+        if(std::abs(entry.value / divisor) > MAX_ENTRY)
+        {
+            overflow = true;
+            return;
+        }
+        scratch.push_back({entry.col, static_cast<int>(entry.value / divisor)});
+    }
+
+    Span& span = spans[row];
+    if(static_cast<int>(scratch.size()) > span.capacity)
+    {
+        span.start = pool.size();
+        span.capacity = scratch.size();
+        pool.resize(pool.size() + scratch.size());
+    }
+    std::copy(scratch.begin(), scratch.end(), pool.begin() + span.start);
+    span.size = scratch.size();
+
+    values[row] = value / divisor;
+    normalize(row);
+}
+
+// Divide a row by the gcd of its entries and its value, and make its first coefficient positive. Most rows have a coefficient of 1 or -1, which ends the gcd early.
+void SparseSystem::normalize(int row)
+{
+    Entry* first = pool.data() + spans[row].start;
+    Entry* last = first + spans[row].size;
+
+    int divisor = 0;
+    for(Entry* entry = first; entry != last && divisor != 1; ++entry)
+    {
+        divisor = std::gcd(divisor, std::abs(entry->value));
+    }
+    if(divisor != 1)
+    {
+        divisor = std::gcd(divisor, std::abs(values[row]));
+    }
+
+    if(first != last && first->value < 0)
+    {
+        divisor = -divisor;
+    }
+    if(divisor == 0 || divisor == 1)
+    {
+        return;
+    }
+
+    for(Entry* entry = first; entry != last; ++entry)
+    {
+        entry->value /= divisor;
+    }
+    values[row] /= divisor;
+}
+
+// Bring the system to reduced row echelon form. Returns false if that would take coefficients bigger than MAX_ENTRY, in which case the rows are
+// left part way and nothing should be deduced from them.
+bool SparseSystem::eliminate()
+{
+    if(num_cols < SPARSE_MIN_COLS && eliminate_dense())
+    {
+        return true;
+    }
+
+    std::vector<int> col_count(num_cols);
+    col_head = std::vector<int>(num_cols, -1);
+    links.clear();
+    links.reserve(2 * pool.size());
+    scratch.reserve(num_cols);
+    wide.reserve(num_cols);
+
+    // Linked last row first, so each list runs in row order
+    for(int row = height() - 1; row >= 0; --row)
+    {
+        for(const Entry& entry : this->row(row))
+        {
+            link(entry.col, row);
+            ++col_count[entry.col];
+        }
+    }
+
+    // Columns in order of how many rows they are in. A cell is next to at most 8 hints, so one pass per count finds them all without sorting. The
+    // clamp only matters for a system that did not come from a board, and puts its busier columns in the last pass.
+    for(int count = 1; count <= MAX_COL_COUNT; ++count)
+    {
+        for(int col = 0; col < num_cols; ++col)
+        {
+            if(std::min(col_count[col], MAX_COL_COUNT) == count)
+            {
+                pivot_column(col);
+            }
+        }
+    }
+
+    if(overflow)
+    {
+        return false;
+    }
+    for(int row = 0; row < height(); ++row)
+    {
+        normalize(row);
+    }
+    return true;
+}
+
+// Reduce the rows as a dense Matrix and read them back. The last column of the matrix holds the values. Each thread keeps one Matrix for this, so
+// its buffer is only allocated once. Returns false, and leaves the rows alone, if Matrix::rref gives up.
+bool SparseSystem::eliminate_dense()
+{
+    static thread_local Matrix matrix;
+    matrix.reset(height(), num_cols + 1);
+    for(int row = 0; row < height(); ++row)
+    {
+        for(const Entry& entry : this->row(row))
+        {
+            matrix(row, entry.col) = entry.value;
+        }
+        matrix(row, num_cols) = values[row];
+    }
+
+    if(!matrix.rref())
+    {
+        return false;
+    }
+
+    // The pool is sized once, and then every entry is written but only the nonzero ones are kept, which avoids a branch that mispredicts on
+    // nearly every entry. The last write can land one past the last entry, so there is one spare.
+    int total = 0;
+    for(int row = 0; row < height(); ++row)
+    {
+        for(int col = 0; col < num_cols; ++col)
+        {
+            total += matrix(row, col) != 0;
+        }
+    }
+    pool.resize(total + 1);
+
+    Entry* out = pool.data();
+    for(int row = 0; row < height(); ++row)
+    {
+        const Matrix::value_type* in = matrix(row);
+        int size = 0;
+        for(int col = 0; col < num_cols; ++col)
+        {
+            out[size] = {col, in[col]};
+            size += in[col] != 0;
+        }
+
+        Span& span = spans[row];
+        span.start = out - pool.data();
+        span.size = span.capacity = size;
+        out += size;
+        values[row] = matrix(row, num_cols);
+        normalize(row);
+    }
+    pool.pop_back();
+    return true;
+}
+
+// Pick a pivot row for col and clear col from every other row.
+void SparseSystem::pivot_column(int col)
+{
+    // Shortest row not yet used as a pivot with this column, preferring a coefficient of 1 or -1 so the other rows don't need scaling
+    int pivot = -1;
+    std::pair<int, bool> best;
+    for(int node = col_head[col]; node != -1; node = links[node].next)
+    {
+        int row = links[node].row;
+        int value = spans[row].pivot ? 0 : coefficient(row, col);
+        std::pair<int, bool> rank(spans[row].size, std::abs(value) != 1);
+
+        if(value != 0 && (pivot == -1 || rank < best))
+        {
+            pivot = row;
+            best = rank;
+        }
+    }
+    if(pivot == -1 || overflow)
+    {
+        return;
+    }
+    spans[pivot].pivot = true;
+
+    // Clearing col never adds col back to a row, so its list doesn't change while this runs
+    for(int node = col_head[col]; node != -1; node = links[node].next)
+    {
+        int row = links[node].row;
+        if(row != pivot && coefficient(row, col) != 0 && !overflow)
+        {
+            clear_column(row, pivot, col);
+        }
+    }
+}
+
+// The column of the only entry in a row, or -1 if it has some other number of entries.
+int SparseSystem::is_lonely_row(int row)
+{
+    return spans[row].size == 1 ? pool[spans[row].start].col : -1;
+}
+
+// A row is safe if its value is 0 and all of its coefficients are positive, since then none of its cells can be a mine.
+bool SparseSystem::is_safe_row(int row)
+{
+    if(values[row] != 0 || spans[row].size == 0)
+    {
+        return false;
+    }
+
+    for(const Entry& entry : this->row(row))
+    {
+        if(entry.value < 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,111 @@
+/*
+    The logic matrix as a sparse system of equations, and integer elimination on it.
+
+    Each row is one hint: the frontier cells around it, each with a coefficient, and the number of mines among them. A hint touches at most 8 cells, so a
+    row is a short run of (column, coefficient) entries sorted by column, instead of a dense row that is almost all zeros on a wide frontier. The runs of
+    all of the rows live in one pool. A row that grows past its run during elimination is moved to the end of the pool.
+
+    eliminate brings the system to reduced row echelon form without fractions. A column is cleared from a row by replacing the row with a multiple of
+    itself minus a multiple of the pivot row, in one pass over the two runs, and then dividing it by the gcd of its entries so the numbers stay small.
+    Columns are pivoted in order of how few rows they start out in, and each column's pivot is the shortest row that has it, which keeps down the fill-in
+    that clearing a column adds to the other rows. Every row is left divided by its gcd with its first coefficient positive, so a row that pins down a
+    single cell reads x = 0 or x = 1, the same as in a Matrix after rref.
+
+    Merging runs costs more per entry than the dense row operations, so below SPARSE_MIN_COLS columns, where a dense row is only a few SIMD registers,
+    the rows are copied into a Matrix, reduced with Matrix::rref and copied back. Both ways leave the same facts behind.
+
+    Neither way lets a coefficient overflow. Matrix::rref gives up on a matrix whose entries would not fit in 16 bits, and the system is then reduced
+    the sparse way instead. That works in 64 bits and stores rows divided by their gcd. If a coefficient still does not fit, eliminate returns false
+    and no deductions should be drawn from the system.
+*/
+
+#pragma once
+
+#include "matrix.hpp"
+
+#include <vector>
+
+class SparseSystem
+{
+    public:
+
+    static const int MAX_ENTRY = 1 << 30;   // Largest coefficient kept. Small enough that a * row - b * pivot can't overflow 64 bits on the way
+
+    struct Entry
+    {
+        int col;
+        int value;
+    };
+
+    // The entries of one row. Valid until the system is next changed.
+    struct EntryRange
+    {
+        const Entry* first;
+        const Entry* last;
+
+        const Entry* begin() const { return first; }
+        const Entry* end() const { return last; }
+        int size() const { return last - first; }
+        const Entry& operator[](int i) const { return first[i]; }
+    };
+
+    private:
+
+    static const int SPARSE_MIN_COLS = 96;  // Narrower systems are eliminated as a dense Matrix, whose SIMD row operations are faster at that size
+    static const int MAX_COL_COUNT = 8;     // Most rows a column of the logic matrix can be in, since a frontier cell touches at most 8 hints
+
+    struct Span
+    {
+        int start;
+        int size;
+        int capacity;
+        bool pivot;     // Used as the pivot of a column
+    };
+
+    struct Link
+    {
+        int row;
+        int next;
+    };
+
+    struct WideEntry
+    {
+        int col;
+        long long value;
+    };
+
+    int num_cols;
+    std::vector<Entry> pool;
+    std::vector<Span> spans;
+    std::vector<int> values;                // Right hand side of each row
+
+    // Rows that may have an entry in each column, as linked lists, built by eliminate. Rows that have since lost the entry are left in.
+    std::vector<int> col_head;
+    std::vector<Link> links;
+    std::vector<Entry> scratch;
+    std::vector<WideEntry> wide;
+    bool overflow;                          // Some coefficient would have gone past MAX_ENTRY
+
+    int coefficient(int row, int col);
+    void link(int col, int row);
+    bool eliminate_dense();
+    void pivot_column(int col);
+    void clear_column(int row, int pivot, int col);
+    void normalize(int row);
+
+    public:
+
+    SparseSystem(int num_cols);
+    ~SparseSystem();
+
+    void add_row(const std::vector<int>& cols, int value);
+    bool eliminate();
+
+    int height() const { return spans.size(); }
+    int width() const { return num_cols; }
+    EntryRange row(int row) const { return EntryRange{pool.data() + spans[row].start, pool.data() + spans[row].start + spans[row].size}; }
+    int value(int row) const { return values[row]; }
+
+    int is_lonely_row(int row);
+    bool is_safe_row(int row);
+};
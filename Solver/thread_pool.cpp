@@ -0,0 +1,132 @@
+#include "thread_pool.hpp"
+
+WorkStealingPool::WorkStealingPool(int num_threads) : workers(num_threads)
+{
+    pending = 0;
+    queued = 0;
+    next_queue = 0;
+    stopping = false;
+
+    // The thread that calls wait() works as worker 0, so only the rest need threads of their own.
+    for(int id = 1; id < num_threads; ++id)
+    {
+        threads.emplace_back(&WorkStealingPool::worker_loop, this, id);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        stopping = true;
+    }
+    work_available.notify_all();
+
+    for(std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+// Run one task, from this worker's own queue if it has one, otherwise stolen from another worker. Returns false if every queue was empty.
+bool WorkStealingPool::run_one(int id)
+{
+    std::function<void(int)> task;
+    int num_workers = workers.size();
+
+    {
+        std::lock_guard<std::mutex> lock(workers[id].mutex);
+        if(!workers[id].tasks.empty())
+        {
+            task = std::move(workers[id].tasks.back());
+            workers[id].tasks.pop_back();
+        }
+    }
+
+    for(int offset = 1; !task && offset < num_workers; ++offset)
+    {
+        Worker& victim = workers[(id + offset) % num_workers];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if(!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+        }
+    }
+
+    if(!task)
+    {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        --queued;
+    }
+
+    task(id);
+
+    std::lock_guard<std::mutex> lock(state_mutex);
+    if(--pending == 0)
+    {
+        work_done.notify_all();
+    }
+    return true;
+}
+
+void WorkStealingPool::worker_loop(int id)
+{
+    while(true)
+    {
+        if(run_one(id))
+        {
+            continue;
+        }
+
+        // Tasks that are already running can't be stolen, so sleep until one is waiting in a queue rather than until none are pending.
+        std::unique_lock<std::mutex> lock(state_mutex);
+        work_available.wait(lock, [this]() { return stopping || queued > 0; });
+        if(stopping)
+        {
+            return;
+        }
+    }
+}
+
+// Queue a task. Tasks are dealt out to the workers' queues in turn and rebalanced by stealing. It is only counted as queued once it is in a queue,
+// so a worker never wakes up for a task it can't find yet.
+void WorkStealingPool::submit(std::function<void(int)> task)
+{
+    int id;
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        ++pending;
+        id = next_queue;
+        next_queue = (next_queue + 1) % workers.size();
+    }
+    {
+        std::lock_guard<std::mutex> lock(workers[id].mutex);
+        workers[id].tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        ++queued;
+    }
+    work_available.notify_one();
+}
+
+// Help run tasks until every submitted task has finished.
+void WorkStealingPool::wait()
+{
+    while(run_one(0))
+    {
+
+    }
+
+    std::unique_lock<std::mutex> lock(state_mutex);
+    work_done.wait(lock, [this]() { return pending == 0; });
+}
+
+int WorkStealingPool::size()
+{
+    return workers.size();
+}
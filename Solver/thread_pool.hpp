@@ -0,0 +1,50 @@
+/*
+    A fixed set of worker threads that share work by stealing. Each worker has its own queue of tasks and takes new work from the back of it. When its
+    queue is empty it takes the oldest task from the front of another worker's queue, so a worker that was handed a large piece of the search keeps the
+    others busy with the parts it has not reached yet.
+
+    Tasks are told which worker is running them, so they can keep per-worker state without locking.
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool
+{
+    private:
+
+    struct Worker
+    {
+        std::deque<std::function<void(int)> > tasks;
+        std::mutex mutex;
+    };
+
+    std::vector<Worker> workers;
+    std::vector<std::thread> threads;
+
+    std::mutex state_mutex;
+    std::condition_variable work_available;
+    std::condition_variable work_done;
+    int pending;                // Submitted tasks that have not finished
+    int queued;                 // Submitted tasks still waiting in a queue, which an idle worker could take
+    int next_queue;
+    bool stopping;
+
+    bool run_one(int id);
+    void worker_loop(int id);
+
+    public:
+
+    WorkStealingPool(int num_threads);
+    ~WorkStealingPool();
+
+    void submit(std::function<void(int)> task);
+    void wait();
+    int size();
+};
@@ -0,0 +1,71 @@
+/*
+    Checks Solver::best_moves against calling Solver::best_move on each board.
+
+    The boards are the seeded positions that MinesweeperBenchmark uses. best_moves may pick a different guaranteed safe cell than best_move does, and a
+    board left to best_move may get a different random cell where several are as safe as each other, so the moves are not compared directly. Instead
+    each board's moves must be the same cell or be exactly as likely to be a mine, as worked out by mine_probabilities on that board.
+
+    Launch using: ./BatchTest
+*/
+
+#include "../Benchmark/workload.hpp"
+#include "../Solver/batch.hpp"
+#include "../Solver/solver.hpp"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// Returns the number of boards whose batch move is less safe than, or just different from, their own best_move.
+static int check_workload(const Workload& workload)
+{
+    BoardBatch batch(workload.nrows, workload.ncols, workload.positions.size());
+    for(size_t board = 0; board < workload.positions.size(); ++board)
+    {
+        batch.set_board(board, workload.positions[board]);
+    }
+
+    Solver batch_solver, board_solver, probability_solver;
+    std::vector<std::pair<int, int> > moves = batch_solver.best_moves(batch, workload.num_mines);
+
+    int same = 0, equally_safe = 0, wrong = 0;
+    for(size_t board = 0; board < workload.positions.size(); ++board)
+    {
+        const std::vector<std::vector<int> >& position = workload.positions[board];
+        std::pair<int, int> expected = board_solver.best_move(position, workload.num_mines);
+        std::pair<int, int> move = moves[board];
+
+        if(move == expected)
+        {
+            ++same;
+            continue;
+        }
+
+        std::vector<std::vector<double> > probabilities = probability_solver.mine_probabilities(position, workload.num_mines);
+        bool hidden = position[move.first][move.second] == -1;
+        if(hidden && std::abs(probabilities[move.first][move.second] - probabilities[expected.first][expected.second]) < 1e-9)
+        {
+            ++equally_safe;
+        }
+        else
+        {
+            ++wrong;
+        }
+    }
+
+    std::cout << workload.name << ": " << workload.positions.size() << " boards, " << same << " same move, " << equally_safe << " equally safe, "
+              << wrong << " wrong\n";
+    return wrong;
+}
+
+int main()
+{
+    int wrong = 0;
+    for(const Workload& workload : build_standard_workloads(2))
+    {
+        wrong += check_workload(workload);
+    }
+
+    std::cout << (wrong == 0 ? "passed\n" : "FAILED\n");
+    return wrong == 0 ? 0 : 1;
+}
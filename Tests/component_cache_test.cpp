@@ -0,0 +1,292 @@
+/*
+    Checks the canonical form that ComponentCache keys components by.
+
+    Each component is the frontier of a small random board with some of its safe cells revealed. Its exact counts are inserted once, then the same
+    component is looked up again with its cells and hints listed in other random orders, and moved to another spot on a larger board. Each lookup must
+    hit the one entry, and the counts it hands back must be those of the right cells, as a search of the reordered component finds them. Many of the
+    smallest boards have the same shape, and any two components that get the same key must also have the same counts.
+
+    Last, two components with the same degree sequence that are not the same shape, a cycle of four hints and four cells and two separate pairs of hints
+    sharing two cells, must get different keys.
+
+    Launch using: ./ComponentCacheTest
+*/
+
+#include "../Solver/accumulator.hpp"
+#include "../Solver/component_cache.hpp"
+#include "../Solver/frontier.hpp"
+#include "../Solver/geometry.hpp"
+#include "../Solver/matrix.hpp"
+#include "../Solver/rng.hpp"
+#include "../Solver/search.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <utility>
+#include <vector>
+
+const int MAX_NODES = 100000;       // Components that need more than this to search are skipped
+const int ORDERINGS = 6;            // Reorderings of each component looked up
+
+struct Counts
+{
+    int components = 0;
+    int lookups = 0;
+    int misses = 0;
+    int failures = 0;
+};
+
+// A random board with the given density of mines, as the grid the Solver is given: -1 for hidden cells and the hint of each revealed one.
+static std::vector<std::vector<int> > random_grid(Rng& rng, int nrows, int ncols, int mine_percent, int reveal_percent)
+{
+    std::vector<std::vector<bool> > mine(nrows, std::vector<bool>(ncols));
+    for(int row = 0; row < nrows; ++row)
+    {
+        for(int col = 0; col < ncols; ++col)
+        {
+            mine[row][col] = rng.uniform(100) < mine_percent;
+        }
+    }
+
+    const BoardGeometry& geometry = BoardGeometry::get(nrows, ncols);
+    std::vector<std::vector<int> > grid(nrows, std::vector<int>(ncols, -1));
+    for(int row = 0; row < nrows; ++row)
+    {
+        for(int col = 0; col < ncols; ++col)
+        {
+            if(mine[row][col] || rng.uniform(100) >= reveal_percent)
+            {
+                continue;
+            }
+            grid[row][col] = 0;
+            for(const std::pair<int, int>& index : geometry.adjacent(row, col))
+            {
+                grid[row][col] += mine[index.first][index.second];
+            }
+        }
+    }
+    return grid;
+}
+
+// The hidden cells next to a hint and the hints next to them, listed in the order given by cells and hints, which must hold every one of each.
+static FrontierComponent make_component(const std::vector<std::pair<int, int> >& cells, const std::vector<std::pair<int, int> >& hints)
+{
+    FrontierComponent component;
+    for(const std::pair<int, int>& cell : cells)
+    {
+        component.fmap.add(cell.first, cell.second);
+    }
+    component.hints = hints;
+    return component;
+}
+
+// Every hint of grid that has a hidden cell next to it, and those cells, in board order.
+static void frontier(const std::vector<std::vector<int> >& grid, std::vector<std::pair<int, int> >& cells, std::vector<std::pair<int, int> >& hints)
+{
+    int nrows = grid.size(), ncols = grid[0].size();
+    const BoardGeometry& geometry = BoardGeometry::get(nrows, ncols);
+    std::vector<std::vector<bool> > added(nrows, std::vector<bool>(ncols));
+
+    for(int row = 0; row < nrows; ++row)
+    {
+        for(int col = 0; col < ncols; ++col)
+        {
+            if(grid[row][col] < 0)
+            {
+                continue;
+            }
+
+            bool hint = false;
+            for(const std::pair<int, int>& index : geometry.adjacent(row, col))
+            {
+                if(grid[index.first][index.second] == -1)
+                {
+                    hint = true;
+                    if(!added[index.first][index.second])
+                    {
+                        added[index.first][index.second] = true;
+                        cells.push_back(index);
+                    }
+                }
+            }
+            if(hint)
+            {
+                hints.push_back({row, col});
+            }
+        }
+    }
+}
+
+static bool search(Matrix& board, FrontierComponent& component, SolutionAccumulator& solutions)
+{
+    ConstraintSearch search(board, component, MAX_NODES);
+    search.solve(solutions);
+    return !search.truncated();
+}
+
+static bool same_counts(const SolutionAccumulator& a, const SolutionAccumulator& b)
+{
+    return a.totals == b.totals && a.cell_mines == b.cell_mines;
+}
+
+// Counts of every key seen so far, with each cell's counts under its canonical number, so that any two components with one key can be compared.
+typedef std::map<std::vector<int>, SolutionAccumulator> SeenKeys;
+
+static void check_collision(const CanonicalComponent& canonical, const SolutionAccumulator& solutions, SeenKeys& seen, Counts& counts)
+{
+    SolutionAccumulator by_number(canonical.canonical_cell.size());
+    by_number.totals = solutions.totals;
+    by_number.cell_mines = solutions.cell_mines;
+    for(size_t k = 0; k < solutions.totals.size(); ++k)
+    {
+        for(size_t cell = 0; cell < canonical.canonical_cell.size(); ++cell)
+        {
+            by_number.cell_mines[k][canonical.canonical_cell[cell]] = solutions.cell_mines[k][cell];
+        }
+    }
+
+    auto it = seen.find(canonical.key);
+    if(it == seen.end())
+    {
+        seen.insert({canonical.key, by_number});
+    }
+    else if(!same_counts(it->second, by_number))
+    {
+        ++counts.failures;
+    }
+}
+
+static void check_board(Rng& rng, const std::vector<std::vector<int> >& grid, SeenKeys& seen, Counts& counts)
+{
+    std::vector<std::pair<int, int> > cells, hints;
+    frontier(grid, cells, hints);
+    if(cells.empty())
+    {
+        return;
+    }
+
+    Matrix board(grid);
+    FrontierComponent component = make_component(cells, hints);
+    SolutionAccumulator expected(component.fmap.size());
+    if(!search(board, component, expected))
+    {
+        return;
+    }
+    ++counts.components;
+
+    ComponentCache cache(16);
+    CanonicalComponent canonical = ComponentCache::canonicalize(board, component);
+    cache.insert(canonical, expected);
+    check_collision(canonical, expected, seen, counts);
+
+    // The same board moved 2 rows down and 3 columns right, with revealed cells around it that touch no hidden ones
+    int nrows = grid.size(), ncols = grid[0].size();
+    std::vector<std::vector<int> > moved_grid(nrows + 4, std::vector<int>(ncols + 6, 0));
+    for(int row = 0; row < nrows; ++row)
+    {
+        for(int col = 0; col < ncols; ++col)
+        {
+            moved_grid[row + 2][col + 3] = grid[row][col];
+        }
+    }
+    Matrix moved_board(moved_grid);
+
+    for(int ordering = 0; ordering <= ORDERINGS; ++ordering)
+    {
+        std::vector<std::pair<int, int> > order_cells(cells), order_hints(hints);
+        for(size_t i = order_cells.size(); i > 1; --i)
+        {
+            std::swap(order_cells[i - 1], order_cells[rng.uniform(i)]);
+        }
+        for(size_t i = order_hints.size(); i > 1; --i)
+        {
+            std::swap(order_hints[i - 1], order_hints[rng.uniform(i)]);
+        }
+
+        // The last ordering is looked up on the moved board instead
+        bool moved = ordering == ORDERINGS;
+        if(moved)
+        {
+            for(std::pair<int, int>& cell : order_cells)
+            {
+                cell = {cell.first + 2, cell.second + 3};
+            }
+            for(std::pair<int, int>& hint : order_hints)
+            {
+                hint = {hint.first + 2, hint.second + 3};
+            }
+        }
+        Matrix& order_board = moved ? moved_board : board;
+
+        FrontierComponent reordered = make_component(order_cells, order_hints);
+        SolutionAccumulator reordered_expected(reordered.fmap.size()), cached(reordered.fmap.size());
+        search(order_board, reordered, reordered_expected);
+
+        ++counts.lookups;
+        if(!cache.lookup(ComponentCache::canonicalize(order_board, reordered), cached))
+        {
+            ++counts.misses;
+            continue;
+        }
+        counts.failures += !same_counts(cached, reordered_expected);
+    }
+    counts.failures += cache.size() != 1;
+}
+
+// Two components with 4 hints of value 1 on 2 cells each and 4 cells next to 2 hints each. The first is a single cycle, the second two pairs of hints
+// that share both of their cells, so the first has 2 solutions and the second 4.
+static bool check_same_degrees()
+{
+    // Cells at the corners of a square, with the hints on the middle of its sides between them
+    std::vector<std::vector<int> > cycle_grid = {
+        {-1,  1, -1},
+        { 1,  0,  1},
+        {-1,  1, -1}};
+    FrontierComponent cycle = make_component({{0, 0}, {0, 2}, {2, 0}, {2, 2}}, {{0, 1}, {1, 0}, {1, 2}, {2, 1}});
+
+    // Two cells side by side with two hints under them, twice
+    std::vector<std::vector<int> > pairs_grid = {
+        {-1, -1,  0,  0, -1, -1},
+        { 1,  1,  0,  0,  1,  1},
+        { 0,  0,  0,  0,  0,  0}};
+    FrontierComponent pairs = make_component({{0, 0}, {0, 1}, {0, 4}, {0, 5}}, {{1, 0}, {1, 1}, {1, 4}, {1, 5}});
+
+    Matrix cycle_board(cycle_grid), pairs_board(pairs_grid);
+    CanonicalComponent cycle_key = ComponentCache::canonicalize(cycle_board, cycle);
+    CanonicalComponent pairs_key = ComponentCache::canonicalize(pairs_board, pairs);
+
+    SolutionAccumulator cycle_solutions(4), pairs_solutions(4), cached(4);
+    search(cycle_board, cycle, cycle_solutions);
+    search(pairs_board, pairs, pairs_solutions);
+
+    ComponentCache cache(16);
+    cache.insert(cycle_key, cycle_solutions);
+    bool ok = cycle_key.key != pairs_key.key && !cache.lookup(pairs_key, cached);
+    ok = ok && cycle_solutions.totals[2] == 2 && pairs_solutions.totals[2] == 4;
+
+    std::cout << "same degrees: " << (ok ? "different keys" : "keys collide") << "\n";
+    return ok;
+}
+
+int main()
+{
+    Rng rng(1);
+    bool ok = true;
+
+    SeenKeys seen;
+    Counts counts;
+    for(int i = 0; i < 1000; ++i)
+    {
+        check_board(rng, random_grid(rng, 6 + rng.uniform(3), 6 + rng.uniform(3), 20, 40 + rng.uniform(30)), seen, counts);
+        check_board(rng, random_grid(rng, 3, 3 + rng.uniform(2), 20, 60), seen, counts);
+    }
+    std::cout << "components: " << counts.components << ", " << seen.size() << " keys, " << counts.lookups << " lookups, " << counts.misses
+              << " missed, " << counts.failures << " wrong\n";
+    ok = counts.failures == 0 && counts.misses == 0 && counts.components >= 1000 && seen.size() < static_cast<size_t>(counts.components) && ok;
+
+    ok = check_same_degrees() && ok;
+
+    std::cout << (ok ? "passed\n" : "FAILED\n");
+    return ok ? 0 : 1;
+}
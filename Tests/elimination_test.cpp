@@ -0,0 +1,232 @@
+/*
+    Checks SparseSystem::eliminate against systems with a known solution.
+
+    Each system comes from a planted assignment of mines, either a random board with some of its safe cells revealed, or random rows of up to 8
+    nearby columns. Row operations never change which assignments satisfy a system, so after elimination every row must still hold for the planted
+    mines, and every cell the rows pin down must match them. A system that eliminate gives up on must say so rather than return wrong rows.
+
+    Board systems go from a few columns to a few hundred, with many near 90, just under where eliminate switches from the dense path to the sparse
+    one. The random systems are 95 and 400 columns wide, which are the dense path with many rows and the sparse path. They are also fed one row at a
+    time to an IncrementalSystem, whose find_move must only give away cells that match.
+
+    Launch using: ./EliminationTest
+*/
+
+#include "../Solver/geometry.hpp"
+#include "../Solver/incremental.hpp"
+#include "../Solver/rng.hpp"
+#include "../Solver/sparse.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+struct Counts
+{
+    int systems = 0;
+    int gave_up = 0;
+    int widest = 0;
+    int near_90 = 0;        // Systems of 80 to 100 columns, where the dense path used to overflow
+    int failures = 0;
+};
+
+// Eliminate a copy of system and check it against the planted mines.
+static void check(const SparseSystem& system, const std::vector<int>& mines, Counts& counts)
+{
+    SparseSystem solved(system);
+    ++counts.systems;
+    counts.widest = std::max(counts.widest, system.width());
+    counts.near_90 += system.width() >= 80 && system.width() <= 100;
+
+    if(!solved.eliminate())
+    {
+        ++counts.gave_up;
+        return;
+    }
+
+    for(int row = 0; row < solved.height(); ++row)
+    {
+        long long sum = 0;
+        for(const SparseSystem::Entry& entry : solved.row(row))
+        {
+            sum += static_cast<long long>(entry.value) * mines[entry.col];
+        }
+
+        int col = solved.is_lonely_row(row);
+        bool wrong_sum = sum != solved.value(row);
+        bool wrong_cell = col != -1 && solved.value(row) != mines[col];
+        bool wrong_safe = false;
+        if(solved.is_safe_row(row))
+        {
+            for(const SparseSystem::Entry& entry : solved.row(row))
+            {
+                wrong_safe = wrong_safe || mines[entry.col];
+            }
+        }
+
+        if(wrong_sum || wrong_cell || wrong_safe)
+        {
+            ++counts.failures;
+            return;
+        }
+    }
+}
+
+// The same for an IncrementalSystem with the cells in one board row, which can only be checked through the cells find_move gives away.
+static void check_incremental(IncrementalSystem& system, const std::vector<int>& mines, Counts& counts)
+{
+    ++counts.systems;
+    counts.widest = std::max(counts.widest, system.width());
+    counts.near_90 += system.width() >= 80 && system.width() <= 100;
+    if(system.overflowed())
+    {
+        ++counts.gave_up;
+        return;
+    }
+
+    std::vector<std::pair<int, int> > found_mines;
+    std::pair<int, int> move(-1, -1);
+    bool found = system.find_move(found_mines, move);
+
+    bool wrong = found && mines[move.second];
+    for(const std::pair<int, int>& mine : found_mines)
+    {
+        wrong = wrong || !mines[mine.second];
+    }
+    counts.failures += wrong;
+}
+
+// A random board with the given density of mines, with each safe cell revealed with the given chance. Rows are the revealed cells next to hidden ones.
+static void check_board(Rng& rng, int nrows, int ncols, int mine_percent, int reveal_percent, Counts& counts)
+{
+    std::vector<int> mine(nrows * ncols);
+    std::vector<bool> revealed(nrows * ncols);
+    for(int cell = 0; cell < nrows * ncols; ++cell)
+    {
+        mine[cell] = rng.uniform(100) < mine_percent;
+        revealed[cell] = !mine[cell] && rng.uniform(100) < reveal_percent;
+    }
+
+    const BoardGeometry& geometry = BoardGeometry::get(nrows, ncols);
+    std::vector<int> col_of(nrows * ncols, -1);
+    std::vector<int> mines;
+    std::vector<std::pair<std::vector<int>, int> > rows;
+
+    for(int cell = 0; cell < nrows * ncols; ++cell)
+    {
+        if(!revealed[cell])
+        {
+            continue;
+        }
+
+        std::vector<int> cols;
+        int value = 0;
+        for(const std::pair<int, int>& index : geometry.adjacent(cell / ncols, cell % ncols))
+        {
+            int neighbor = index.first * ncols + index.second;
+            if(revealed[neighbor])
+            {
+                continue;
+            }
+            if(col_of[neighbor] == -1)
+            {
+                col_of[neighbor] = mines.size();
+                mines.push_back(mine[neighbor]);
+            }
+            cols.push_back(col_of[neighbor]);
+            value += mine[neighbor];
+        }
+        if(!cols.empty())
+        {
+            rows.push_back({cols, value});
+        }
+    }
+
+    SparseSystem system(mines.size());
+    for(const std::pair<std::vector<int>, int>& row : rows)
+    {
+        system.add_row(row.first, row.second);
+    }
+    check(system, mines, counts);
+}
+
+// Random rows of 2 to 8 columns out of a window of 12, sliding along the columns like a frontier does.
+static void check_random(Rng& rng, int num_cols, int num_rows, Counts& counts, Counts& incremental_counts)
+{
+    std::vector<int> mines(num_cols);
+    for(int& mine : mines)
+    {
+        mine = rng.uniform(3) == 0;
+    }
+
+    SparseSystem system(num_cols);
+    IncrementalSystem incremental(1, num_cols);
+    for(int row = 0; row < num_rows; ++row)
+    {
+        int start = rng.uniform(num_cols - 12);
+        int size = 2 + rng.uniform(7);
+        std::vector<bool> used(12);
+        std::vector<int> cols;
+        int value = 0;
+        while(static_cast<int>(cols.size()) < size)
+        {
+            int offset = rng.uniform(12);
+            if(!used[offset])
+            {
+                used[offset] = true;
+                cols.push_back(start + offset);
+                value += mines[start + offset];
+            }
+        }
+        system.add_row(cols, value);
+
+        std::vector<std::pair<int, int> > cells;
+        for(int col : cols)
+        {
+            cells.push_back({0, col});
+        }
+        incremental.add_row(cells, value);
+    }
+    check(system, mines, counts);
+    check_incremental(incremental, mines, incremental_counts);
+}
+
+static bool report(const char* name, const Counts& counts)
+{
+    std::cout << name << ": " << counts.systems << " systems, widest " << counts.widest << " columns, " << counts.near_90 << " of 80 to 100 columns, "
+              << counts.gave_up << " gave up, " << counts.failures << " wrong\n";
+    return counts.failures == 0;
+}
+
+int main()
+{
+    Rng rng(1);
+    bool ok = true;
+
+    Counts boards;
+    for(int i = 0; i < 2000; ++i)
+    {
+        check_board(rng, 12, 16, 20, 30 + rng.uniform(30), boards);
+        check_board(rng, 16, 30, 20, 20 + rng.uniform(40), boards);
+    }
+    ok = report("boards", boards) && ok;
+    ok = boards.near_90 >= 100 && ok;
+
+    Counts dense, incremental;
+    for(int i = 0; i < 500; ++i)
+    {
+        check_random(rng, 95, 120, dense, incremental);
+    }
+    ok = report("random 95 columns", dense) && ok;
+
+    Counts sparse;
+    for(int i = 0; i < 200; ++i)
+    {
+        check_random(rng, 400, 350, sparse, incremental);
+    }
+    ok = report("random 400 columns", sparse) && ok;
+    ok = report("incremental", incremental) && ok;
+
+    std::cout << (ok ? "passed\n" : "FAILED\n");
+    return ok ? 0 : 1;
+}
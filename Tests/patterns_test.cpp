@@ -0,0 +1,232 @@
+/*
+    Checks the generated pattern table and find_pattern_move against brute force.
+
+    Every key the table could be asked for, any sizes of the three groups that fit around two hints and any values from 1 to 7, is looked up through the
+    perfect hash the way find_pattern_move does. Its flags must be the ones found by trying every number of mines in each group, and keys that force
+    nothing must not be found. The table must hold nothing else, so a change to the generator, the key layout or the hash that loses or corrupts an
+    entry fails here.
+
+    Then pairs of hints are put down at every offset find_pattern_move tries, with random cells around them hidden and mines planted among those, and
+    find_pattern_move is run on just that pair. Every placement of mines in the hidden cells that satisfies both hints is tried, and the safe cell and
+    mines it gives must hold in all of them. Whenever some cell is safe in all of them, and the pair is one that gets looked up, find_pattern_move must
+    find a safe cell.
+
+    Launch using: ./PatternsTest
+*/
+
+#include "../Solver/geometry.hpp"
+#include "../Solver/matrix.hpp"
+#include "../Solver/patterns.hpp"
+#include "../Solver/rng.hpp"
+
+#include "pattern_table.inc"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+// The flags forced on a pair of hints, from every number of mines in each group that satisfies both, or 0 if nothing is forced or none do.
+static uint32_t brute_force_flags(int only_first, int shared, int only_second, int first_value, int second_value)
+{
+    uint32_t always = 0;
+    bool satisfiable = false;
+
+    for(int a = 0; a <= only_first; ++a)
+    {
+        for(int s = 0; s <= shared; ++s)
+        {
+            for(int b = 0; b <= only_second; ++b)
+            {
+                if(a + s != first_value || s + b != second_value)
+                {
+                    continue;
+                }
+
+                uint32_t flags = (a == 0 ? PATTERN_FIRST_SAFE : 0) | (a == only_first ? PATTERN_FIRST_MINE : 0)
+                                 | (s == 0 ? PATTERN_SHARED_SAFE : 0) | (s == shared ? PATTERN_SHARED_MINE : 0)
+                                 | (b == 0 ? PATTERN_SECOND_SAFE : 0) | (b == only_second ? PATTERN_SECOND_MINE : 0);
+                always = satisfiable ? always & flags : flags;
+                satisfiable = true;
+            }
+        }
+    }
+
+    // An empty group is trivially both safe and all mines, which says nothing
+    uint32_t empty = (only_first ? 0 : PATTERN_FIRST_SAFE | PATTERN_FIRST_MINE) | (shared ? 0 : PATTERN_SHARED_SAFE | PATTERN_SHARED_MINE)
+                     | (only_second ? 0 : PATTERN_SECOND_SAFE | PATTERN_SECOND_MINE);
+    return satisfiable ? always & ~empty : 0;
+}
+
+// The flags the table has for key, looked up through the perfect hash as find_pattern_move does.
+static uint32_t table_flags(uint32_t key)
+{
+    uint32_t seed = PATTERN_SEEDS[pattern_hash(key, 0) % PATTERN_BUCKETS];
+    uint32_t entry = PATTERN_TABLE[pattern_hash(key, seed) % PATTERN_SLOTS];
+
+    return entry >> PATTERN_FLAG_BITS == key ? entry & ((1 << PATTERN_FLAG_BITS) - 1) : 0;
+}
+
+static bool check_table()
+{
+    int keys = 0, entries = 0, wrong = 0;
+    for(int only_first = 0; only_first <= 8; ++only_first)
+    {
+        for(int shared = 1; shared <= 4 && only_first + shared <= 8; ++shared)
+        {
+            for(int only_second = 0; shared + only_second <= 8; ++only_second)
+            {
+                for(int first_value = 1; first_value <= 7; ++first_value)
+                {
+                    for(int second_value = 1; second_value <= 7; ++second_value)
+                    {
+                        // Hints that are 0 or full are settled before the table is asked, so only these can be looked up
+                        bool open = first_value < only_first + shared && second_value < shared + only_second;
+                        uint32_t expected = open ? brute_force_flags(only_first, shared, only_second, first_value, second_value) : 0;
+                        uint32_t key = pattern_key(only_first, shared, only_second, first_value, second_value);
+
+                        ++keys;
+                        entries += expected != 0;
+                        wrong += open && table_flags(key) != expected;
+                    }
+                }
+            }
+        }
+    }
+
+    int filled = 0;
+    for(int slot = 0; slot < PATTERN_SLOTS; ++slot)
+    {
+        filled += PATTERN_TABLE[slot] != PATTERN_EMPTY;
+    }
+
+    std::cout << "table: " << keys << " keys, " << entries << " that force something, " << filled << " filled slots, " << wrong << " wrong\n";
+    return wrong == 0 && filled == entries && entries > 0;
+}
+
+static bool touches(const std::pair<int, int>& a, const std::pair<int, int>& b)
+{
+    return std::abs(a.first - b.first) <= 1 && std::abs(a.second - b.second) <= 1;
+}
+
+struct Counts
+{
+    int pairs = 0;
+    int found = 0;
+    int forced = 0;
+    int missed = 0;
+    int failures = 0;
+};
+
+// Two hints at offset from each other on a 6 by 7 board. Each other cell around them is hidden with a chance of 3 in 4, and each hidden cell is a mine
+// with a chance of about 1 in 3.
+static void check_pair(Rng& rng, const std::pair<int, int>& offset, Counts& counts)
+{
+    const int nrows = 6, ncols = 7;
+    const BoardGeometry& geometry = BoardGeometry::get(nrows, ncols);
+    std::pair<int, int> first(1 + rng.uniform(2), 2 + rng.uniform(2));
+    std::pair<int, int> second(first.first + offset.first, first.second + offset.second);
+
+    std::vector<std::vector<int> > grid(nrows, std::vector<int>(ncols, 0));
+    std::vector<std::pair<int, int> > cells;
+    std::vector<bool> mine;
+    for(const std::pair<int, int>& hint : {first, second})
+    {
+        for(const std::pair<int, int>& index : geometry.adjacent(hint.first, hint.second))
+        {
+            if(index == first || index == second || grid[index.first][index.second] == -1 || rng.uniform(100) < 25)
+            {
+                continue;
+            }
+            grid[index.first][index.second] = -1;
+            cells.push_back(index);
+            mine.push_back(rng.uniform(100) < 35);
+        }
+    }
+
+    // A pair is only looked up if both hints are more than 0 and less than their hidden cells, and they share one
+    std::vector<int> values;
+    bool open = true;
+    int shared = 0;
+    for(const std::pair<int, int>& hint : {first, second})
+    {
+        int value = 0, hidden = 0;
+        for(size_t cell = 0; cell < cells.size(); ++cell)
+        {
+            value += mine[cell] && touches(hint, cells[cell]);
+            hidden += touches(hint, cells[cell]);
+        }
+        grid[hint.first][hint.second] = value;
+        values.push_back(value);
+        open = open && value > 0 && value < hidden;
+    }
+    for(const std::pair<int, int>& cell : cells)
+    {
+        shared += touches(first, cell) && touches(second, cell);
+    }
+
+    // Which cells are safe and which are mines in every placement that satisfies both hints
+    std::vector<bool> always_safe(cells.size(), true), always_mine(cells.size(), true);
+    for(uint32_t placement = 0; placement < 1u << cells.size(); ++placement)
+    {
+        int first_mines = 0, second_mines = 0;
+        for(size_t cell = 0; cell < cells.size(); ++cell)
+        {
+            bool is_mine = placement >> cell & 1;
+            first_mines += is_mine && touches(first, cells[cell]);
+            second_mines += is_mine && touches(second, cells[cell]);
+        }
+        if(first_mines != values[0] || second_mines != values[1])
+        {
+            continue;
+        }
+        for(size_t cell = 0; cell < cells.size(); ++cell)
+        {
+            always_safe[cell] = always_safe[cell] && !(placement >> cell & 1);
+            always_mine[cell] = always_mine[cell] && (placement >> cell & 1);
+        }
+    }
+
+    Matrix board(grid);
+    std::vector<std::pair<int, int> > mines;
+    std::pair<int, int> move(-1, -1);
+    bool found = find_pattern_move(board, {first, second}, mines, move);
+    ++counts.pairs;
+    counts.found += found;
+
+    bool any_safe = open && shared > 0 && std::find(always_safe.begin(), always_safe.end(), true) != always_safe.end();
+    counts.forced += any_safe;
+    counts.missed += any_safe && !found;
+
+    bool wrong = false;
+    for(size_t cell = 0; cell < cells.size(); ++cell)
+    {
+        wrong = wrong || (found && cells[cell] == move && !always_safe[cell]);
+        wrong = wrong || (std::find(mines.begin(), mines.end(), cells[cell]) != mines.end() && !always_mine[cell]);
+    }
+    wrong = wrong || (found && grid[move.first][move.second] != -1);
+    counts.failures += wrong;
+}
+
+int main()
+{
+    Rng rng(1);
+    bool ok = check_table();
+
+    // Every offset find_pattern_move pairs hints at
+    const std::pair<int, int> offsets[] = {
+        {0, 1}, {0, 2}, {1, -2}, {1, -1}, {1, 0}, {1, 1}, {1, 2}, {2, -2}, {2, -1}, {2, 0}, {2, 1}, {2, 2}};
+
+    Counts counts;
+    for(int i = 0; i < 10000; ++i)
+    {
+        check_pair(rng, offsets[rng.uniform(12)], counts);
+    }
+    std::cout << "pairs: " << counts.pairs << ", " << counts.found << " found a safe cell, " << counts.forced << " had one, " << counts.missed
+              << " missed, " << counts.failures << " wrong\n";
+    ok = counts.failures == 0 && counts.missed == 0 && counts.found >= 100 && ok;
+
+    std::cout << (ok ? "passed\n" : "FAILED\n");
+    return ok ? 0 : 1;
+}
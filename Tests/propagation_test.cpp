@@ -0,0 +1,154 @@
+/*
+    Checks find_propagated_move against boards with a known layout.
+
+    Each board is a random layout with some of its safe cells revealed and some of its mines already known, normalized the way the Solver hands boards
+    to it: known mines are -2 and each hint has the known mines around it taken off. find_propagated_move is run until it finds nothing more, with each
+    safe cell it finds revealed and each mine it finds marked known before the next run. Every safe cell and every mine it gives must match the layout.
+
+    Launch using: ./PropagationTest
+*/
+
+#include "../Solver/geometry.hpp"
+#include "../Solver/matrix.hpp"
+#include "../Solver/propagation.hpp"
+#include "../Solver/rng.hpp"
+
+#include <iostream>
+#include <utility>
+#include <vector>
+
+const int MAX_RUNS = 50;            // Runs of find_propagated_move on one board, each after applying what the last one found
+
+struct Counts
+{
+    int boards = 0;
+    int runs = 0;
+    int safe = 0;
+    int mines = 0;
+    int failures = 0;
+};
+
+// The normalized board: -1 for hidden cells, -2 for known mines, and for revealed cells the mines around them that aren't known yet.
+static std::vector<std::vector<int> > normalized_grid(const std::vector<std::vector<bool> >& mine, const std::vector<std::vector<int> >& state)
+{
+    int nrows = mine.size(), ncols = mine[0].size();
+    const BoardGeometry& geometry = BoardGeometry::get(nrows, ncols);
+    std::vector<std::vector<int> > grid(state);
+
+    for(int row = 0; row < nrows; ++row)
+    {
+        for(int col = 0; col < ncols; ++col)
+        {
+            if(state[row][col] != 0)
+            {
+                continue;
+            }
+            for(const std::pair<int, int>& index : geometry.adjacent(row, col))
+            {
+                grid[row][col] += mine[index.first][index.second] && state[index.first][index.second] != -2;
+            }
+        }
+    }
+    return grid;
+}
+
+// Revealed cells next to a hidden one.
+static std::vector<std::pair<int, int> > collect_hints(const std::vector<std::vector<int> >& grid)
+{
+    int nrows = grid.size(), ncols = grid[0].size();
+    const BoardGeometry& geometry = BoardGeometry::get(nrows, ncols);
+    std::vector<std::pair<int, int> > hints;
+
+    for(int row = 0; row < nrows; ++row)
+    {
+        for(int col = 0; col < ncols; ++col)
+        {
+            bool hint = false;
+            for(const std::pair<int, int>& index : geometry.adjacent(row, col))
+            {
+                hint = hint || grid[index.first][index.second] == -1;
+            }
+            if(grid[row][col] >= 0 && hint)
+            {
+                hints.push_back({row, col});
+            }
+        }
+    }
+    return hints;
+}
+
+static void check_board(Rng& rng, int nrows, int ncols, int mine_percent, int reveal_percent, int known_percent, Counts& counts)
+{
+    // state is -1 for hidden cells, -2 for known mines and 0 for revealed ones
+    std::vector<std::vector<bool> > mine(nrows, std::vector<bool>(ncols));
+    std::vector<std::vector<int> > state(nrows, std::vector<int>(ncols, -1));
+    for(int row = 0; row < nrows; ++row)
+    {
+        for(int col = 0; col < ncols; ++col)
+        {
+            mine[row][col] = rng.uniform(100) < mine_percent;
+            if(mine[row][col] && rng.uniform(100) < known_percent)
+            {
+                state[row][col] = -2;
+            }
+            else if(!mine[row][col] && rng.uniform(100) < reveal_percent)
+            {
+                state[row][col] = 0;
+            }
+        }
+    }
+    ++counts.boards;
+
+    for(int run = 0; run < MAX_RUNS; ++run)
+    {
+        std::vector<std::vector<int> > grid = normalized_grid(mine, state);
+        Matrix board(grid);
+        std::vector<std::pair<int, int> > mines;
+        std::pair<int, int> move(-1, -1);
+
+        ++counts.runs;
+        if(!find_propagated_move(board, collect_hints(grid), mines, move))
+        {
+            return;
+        }
+
+        bool wrong = grid[move.first][move.second] != -1 || mine[move.first][move.second];
+        for(const std::pair<int, int>& index : mines)
+        {
+            wrong = wrong || grid[index.first][index.second] != -1 || !mine[index.first][index.second];
+        }
+        if(wrong)
+        {
+            ++counts.failures;
+            return;
+        }
+
+        ++counts.safe;
+        counts.mines += mines.size();
+        state[move.first][move.second] = 0;
+        for(const std::pair<int, int>& index : mines)
+        {
+            state[index.first][index.second] = -2;
+        }
+    }
+}
+
+int main()
+{
+    Rng rng(1);
+    Counts counts;
+
+    for(int i = 0; i < 300; ++i)
+    {
+        check_board(rng, 9, 9, 12, 30 + rng.uniform(40), rng.uniform(50), counts);
+        check_board(rng, 16, 16, 16, 30 + rng.uniform(40), rng.uniform(50), counts);
+        check_board(rng, 16, 30, 20, 30 + rng.uniform(40), rng.uniform(50), counts);
+    }
+
+    std::cout << "boards: " << counts.boards << ", " << counts.runs << " runs, " << counts.safe << " safe cells and " << counts.mines << " mines found, "
+              << counts.failures << " wrong\n";
+    bool ok = counts.failures == 0 && counts.safe >= 1000;
+
+    std::cout << (ok ? "passed\n" : "FAILED\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+/*
+    Checks MineSampler against exact enumeration on components small enough to search.
+
+    Each component is the frontier of the left half of a random board, with some of its safe cells revealed, and the rest of the board's mines are spread
+    over the hidden cells off the frontier. The ProbabilityEngine turns both the exact counts of a ConstraintSearch and the sampler's estimate into the
+    chance that each cell is a mine. Every cell the chain moved must be within a few of the sampler's own standard errors of the exact chance, and nearly
+    all of them within two.
+
+    The chain can't always get from every solution to every other, and then some cells never change and get a standard error of 0. Those cells must be
+    right if the exact chance is 0 or 1, and otherwise are counted as unreached. Only a few components may have any.
+
+    Launch using: ./SamplerTest
+*/
+
+#include "../Solver/accumulator.hpp"
+#include "../Solver/frontier.hpp"
+#include "../Solver/geometry.hpp"
+#include "../Solver/matrix.hpp"
+#include "../Solver/probability.hpp"
+#include "../Solver/rng.hpp"
+#include "../Solver/sampler.hpp"
+#include "../Solver/search.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+const int MAX_NODES = 100000;       // Components that need more than this to search are skipped
+const int NUM_SAMPLES = 4000;
+const double MAX_ERRORS = 5.0;      // No cell the chain moved may be further off than this many standard errors
+
+struct Counts
+{
+    int components = 0;
+    int cells = 0;
+    int moved = 0;
+    int within_two = 0;
+    double worst = 0.0;             // Most standard errors any cell the chain moved was off by
+    int unreached = 0;              // Components with cells the chain never moved that aren't settled
+    int failures = 0;
+};
+
+static void check_board(Rng& rng, int nrows, int ncols, int mine_percent, int reveal_percent, Counts& counts)
+{
+    std::vector<std::vector<bool> > mine(nrows, std::vector<bool>(ncols));
+    int num_mines = 0;
+    for(int row = 0; row < nrows; ++row)
+    {
+        for(int col = 0; col < ncols; ++col)
+        {
+            mine[row][col] = rng.uniform(100) < mine_percent;
+            num_mines += mine[row][col];
+        }
+    }
+
+    const BoardGeometry& geometry = BoardGeometry::get(nrows, ncols);
+    std::vector<std::vector<int> > grid(nrows, std::vector<int>(ncols, -1));
+    for(int row = 0; row < nrows; ++row)
+    {
+        for(int col = 0; col < ncols; ++col)
+        {
+            if(mine[row][col] || col >= ncols / 2 || rng.uniform(100) >= reveal_percent)
+            {
+                continue;
+            }
+            grid[row][col] = 0;
+            for(const std::pair<int, int>& index : geometry.adjacent(row, col))
+            {
+                grid[row][col] += mine[index.first][index.second];
+            }
+        }
+    }
+
+    // The whole frontier as one component, with every hidden cell off it counted as outside
+    FrontierComponent component;
+    int hidden = 0;
+    for(int row = 0; row < nrows; ++row)
+    {
+        for(int col = 0; col < ncols; ++col)
+        {
+            hidden += grid[row][col] == -1;
+            bool hint = false;
+            for(const std::pair<int, int>& index : geometry.adjacent(row, col))
+            {
+                if(grid[row][col] >= 0 && grid[index.first][index.second] == -1)
+                {
+                    hint = true;
+                    if(!component.fmap.count(index))
+                    {
+                        component.fmap.add(index.first, index.second);
+                    }
+                }
+            }
+            if(hint)
+            {
+                component.hints.push_back({row, col});
+            }
+        }
+    }
+    int outside_cells = hidden - component.fmap.size();
+    if(component.fmap.size() < 4 || outside_cells < 1)
+    {
+        return;
+    }
+
+    Matrix board(grid);
+    std::vector<SolutionAccumulator> exact(1, SolutionAccumulator(component.fmap.size()));
+    ConstraintSearch search(board, component, MAX_NODES);
+    search.solve(exact[0]);
+    if(search.truncated())
+    {
+        return;
+    }
+
+    std::vector<SolutionAccumulator> sampled(1, SolutionAccumulator(component.fmap.size()));
+    MineSampler sampler(board, component, outside_cells, num_mines, rng.stream(counts.components));
+    if(sampler.sample(NUM_SAMPLES, std::max(sampler.num_hints() / 2, 1), sampled[0]) == 0)
+    {
+        ++counts.failures;
+        return;
+    }
+    std::vector<double> errors = sampler.standard_errors();
+
+    ProbabilityEngine exact_engine, sampled_engine;
+    if(!exact_engine.solve(exact, outside_cells, num_mines) || !sampled_engine.solve(sampled, outside_cells, num_mines))
+    {
+        ++counts.failures;
+        return;
+    }
+    ++counts.components;
+
+    bool unreached = false;
+    for(int cell = 0; cell < component.fmap.size(); ++cell)
+    {
+        double exact_chance = exact_engine.cell_probabilities[0][cell];
+        double off = std::abs(sampled_engine.cell_probabilities[0][cell] - exact_chance);
+        ++counts.cells;
+
+        if(errors[cell] == 0.0)
+        {
+            bool settled = exact_chance < 1e-12 || exact_chance > 1.0 - 1e-12;
+            counts.failures += settled && off > 1e-9;
+            unreached = unreached || !settled;
+            continue;
+        }
+
+        double errors_off = off / errors[cell];
+        ++counts.moved;
+        counts.within_two += errors_off <= 2.0;
+        counts.worst = std::max(counts.worst, errors_off);
+        counts.failures += errors_off > MAX_ERRORS;
+    }
+    counts.unreached += unreached;
+}
+
+int main()
+{
+    Rng rng(1);
+    Counts counts;
+
+    for(int i = 0; i < 100; ++i)
+    {
+        check_board(rng, 6, 12, 20, 40 + rng.uniform(30), counts);
+    }
+
+    double fraction_within_two = static_cast<double>(counts.within_two) / std::max(counts.moved, 1);
+    std::cout << "components: " << counts.components << ", " << counts.cells << " cells, " << counts.moved << " moved, " << fraction_within_two * 100
+              << "% of those within two standard errors, worst " << counts.worst << " standard errors off, " << counts.unreached
+              << " components with unreached cells, " << counts.failures << " wrong\n";
+    bool ok = counts.failures == 0 && counts.components >= 80 && fraction_within_two >= 0.9 && counts.unreached <= counts.components / 20;
+
+    std::cout << (ok ? "passed\n" : "FAILED\n");
+    return ok ? 0 : 1;
+}
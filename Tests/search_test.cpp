@@ -0,0 +1,271 @@
+/*
+    Checks that a ConstraintSearch split across the thread pool counts exactly what the same search counts on one thread.
+
+    Each component is the largest connected piece of the frontier of a random board with some of its safe cells revealed, kept if it has at least 24
+    cells, which is where the Solver starts searching on the pool. The whole search is run on one thread, then split and solved on a WorkStealingPool
+    the way the Solver does it, and the two must give identical totals and cell counts. The split search must also finish on exactly as many nodes as
+    the single one needs and run out on one fewer, however its nodes fall between the subtrees.
+
+    Last, Solver::mine_probabilities must give the same heatmap with 1 and with 4 threads on boards whose largest component is searched on the pool.
+
+    Launch using: ./SearchTest
+*/
+
+#include "../Solver/accumulator.hpp"
+#include "../Solver/frontier.hpp"
+#include "../Solver/geometry.hpp"
+#include "../Solver/matrix.hpp"
+#include "../Solver/rng.hpp"
+#include "../Solver/search.hpp"
+#include "../Solver/solver.hpp"
+#include "../Solver/thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <vector>
+
+const int MIN_CELLS = 24;
+const int MAX_NODES = 100000;       // Components that need more than this on one thread are skipped
+const int SAMPLE_MIN_CELLS = 200;   // The Solver samples components this large without searching them
+
+struct Counts
+{
+    int components = 0;
+    int largest = 0;
+    int subtrees = 0;
+    int failures = 0;
+};
+
+// A random board with the given density of mines, as the grid the Solver is given: -1 for hidden cells and the hint of each revealed one.
+static std::vector<std::vector<int> > random_grid(Rng& rng, int nrows, int ncols, int mine_percent, int reveal_percent)
+{
+    std::vector<std::vector<bool> > mine(nrows, std::vector<bool>(ncols));
+    for(int row = 0; row < nrows; ++row)
+    {
+        for(int col = 0; col < ncols; ++col)
+        {
+            mine[row][col] = rng.uniform(100) < mine_percent;
+        }
+    }
+
+    const BoardGeometry& geometry = BoardGeometry::get(nrows, ncols);
+    std::vector<std::vector<int> > grid(nrows, std::vector<int>(ncols, -1));
+    for(int row = 0; row < nrows; ++row)
+    {
+        for(int col = 0; col < ncols; ++col)
+        {
+            if(mine[row][col] || rng.uniform(100) >= reveal_percent)
+            {
+                continue;
+            }
+            grid[row][col] = 0;
+            for(const std::pair<int, int>& index : geometry.adjacent(row, col))
+            {
+                grid[row][col] += mine[index.first][index.second];
+            }
+        }
+    }
+    return grid;
+}
+
+// The largest connected piece of the grid's frontier, with every hint next to one of its cells.
+static FrontierComponent largest_component(const std::vector<std::vector<int> >& grid)
+{
+    int nrows = grid.size(), ncols = grid[0].size();
+    const BoardGeometry& geometry = BoardGeometry::get(nrows, ncols);
+
+    std::vector<int> piece(nrows * ncols, -1);
+    std::vector<std::vector<int> > pieces;
+    for(int start = 0; start < nrows * ncols; ++start)
+    {
+        if(grid[start / ncols][start % ncols] < 0 || piece[start] != -1)
+        {
+            continue;
+        }
+
+        // Flood fill over hints, linking two hints when they share a hidden cell
+        std::vector<int> stack = {start};
+        piece[start] = pieces.size();
+        pieces.push_back({});
+        while(!stack.empty())
+        {
+            int hint = stack.back();
+            stack.pop_back();
+            pieces.back().push_back(hint);
+
+            for(const std::pair<int, int>& cell : geometry.adjacent(hint / ncols, hint % ncols))
+            {
+                if(grid[cell.first][cell.second] != -1)
+                {
+                    continue;
+                }
+                for(const std::pair<int, int>& other : geometry.adjacent(cell.first, cell.second))
+                {
+                    int index = other.first * ncols + other.second;
+                    if(grid[other.first][other.second] >= 0 && piece[index] == -1)
+                    {
+                        piece[index] = piece[start];
+                        stack.push_back(index);
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<FrontierComponent> components(pieces.size());
+    size_t best = 0;
+    for(size_t p = 0; p < pieces.size(); ++p)
+    {
+        const std::vector<int>& hints = pieces[p];
+        FrontierComponent& component = components[p];
+        for(int hint : hints)
+        {
+            bool frontier = false;
+            for(const std::pair<int, int>& cell : geometry.adjacent(hint / ncols, hint % ncols))
+            {
+                if(grid[cell.first][cell.second] == -1)
+                {
+                    frontier = true;
+                    if(!component.fmap.count(cell))
+                    {
+                        component.fmap.add(cell.first, cell.second);
+                    }
+                }
+            }
+            if(frontier)
+            {
+                component.hints.push_back({hint / ncols, hint % ncols});
+            }
+        }
+        if(component.fmap.size() > components[best].fmap.size())
+        {
+            best = p;
+        }
+    }
+    return components.empty() ? FrontierComponent() : components[best];
+}
+
+static bool same_counts(const SolutionAccumulator& a, const SolutionAccumulator& b)
+{
+    size_t size = std::max(a.totals.size(), b.totals.size());
+    for(size_t k = 0; k < size; ++k)
+    {
+        double total_a = k < a.totals.size() ? a.totals[k] : 0.0;
+        double total_b = k < b.totals.size() ? b.totals[k] : 0.0;
+        if(total_a != total_b)
+        {
+            return false;
+        }
+        if(total_a != 0.0 && a.cell_mines[k] != b.cell_mines[k])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Split the search at depth and solve the subtrees on the pool, as Solver::generate_combinations_parallel does. Returns false if it was truncated.
+static bool solve_split(Matrix& board, FrontierComponent& component, int max_nodes, int depth, WorkStealingPool& pool, SolutionAccumulator& solutions, Counts& counts)
+{
+    std::vector<ConstraintSearch> subtrees;
+    std::atomic<int> shared_nodes(0);
+    ConstraintSearch search(board, component, max_nodes);
+    search.split(depth, shared_nodes, subtrees);
+    counts.subtrees += subtrees.size();
+
+    std::vector<SolutionAccumulator> worker_solutions(pool.size(), SolutionAccumulator(component.fmap.size()));
+    for(ConstraintSearch& subtree : subtrees)
+    {
+        pool.submit([&subtree, &worker_solutions](int worker) -> void {
+            subtree.solve(worker_solutions[worker]);
+        });
+    }
+    pool.wait();
+
+    bool complete = true;
+    for(ConstraintSearch& subtree : subtrees)
+    {
+        complete = complete && !subtree.truncated();
+    }
+    for(SolutionAccumulator& partial : worker_solutions)
+    {
+        solutions.merge(partial);
+    }
+    return complete;
+}
+
+static void check_component(const std::vector<std::vector<int> >& grid, WorkStealingPool& pool, Counts& counts)
+{
+    FrontierComponent component = largest_component(grid);
+    if(component.fmap.size() < MIN_CELLS)
+    {
+        return;
+    }
+
+    Matrix board(grid);
+    SolutionAccumulator expected(component.fmap.size());
+    ConstraintSearch search(board, component, MAX_NODES);
+    search.solve(expected);
+    if(search.truncated())
+    {
+        return;
+    }
+    int needed = search.nodes_visited();
+
+    ++counts.components;
+    counts.largest = std::max(counts.largest, component.fmap.size());
+
+    bool wrong = false;
+    for(int depth : {3, 5})
+    {
+        SolutionAccumulator solutions(component.fmap.size());
+        wrong = wrong || !solve_split(board, component, MAX_NODES, depth, pool, solutions, counts) || !same_counts(solutions, expected);
+
+        // The budget the single search needs exactly, and one node less
+        SolutionAccumulator exact(component.fmap.size()), short_of(component.fmap.size());
+        wrong = wrong || !solve_split(board, component, needed, depth, pool, exact, counts) || !same_counts(exact, expected);
+        wrong = wrong || solve_split(board, component, needed - 1, depth, pool, short_of, counts);
+    }
+    counts.failures += wrong;
+}
+
+int main()
+{
+    Rng rng(1);
+    bool ok = true;
+
+    WorkStealingPool pool(4);
+    Counts counts;
+    for(int i = 0; i < 150; ++i)
+    {
+        check_component(random_grid(rng, 16, 16, 20, 35 + rng.uniform(25)), pool, counts);
+    }
+    std::cout << "components: " << counts.components << " of at least " << MIN_CELLS << " cells, largest " << counts.largest << ", "
+              << counts.subtrees << " subtrees, " << counts.failures << " wrong\n";
+    ok = counts.failures == 0 && counts.components >= 40 && ok;
+
+    int boards = 0, different = 0;
+    for(int i = 0; i < 15; ++i)
+    {
+        std::vector<std::vector<int> > grid = random_grid(rng, 16, 16, 20, 35 + rng.uniform(25));
+        int cells = largest_component(grid).fmap.size();
+        if(cells < MIN_CELLS || cells >= SAMPLE_MIN_CELLS)
+        {
+            continue;
+        }
+
+        // A search that runs out of nodes falls back on sampling, so both solvers get the same seed
+        Solver single, threaded;
+        single.set_rng(Rng(i));
+        threaded.set_rng(Rng(i));
+        threaded.set_num_threads(4);
+        ++boards;
+        different += single.mine_probabilities(grid, 40) != threaded.mine_probabilities(grid, 40);
+    }
+    std::cout << "heatmaps: " << boards << " boards, " << different << " different with 4 threads\n";
+    ok = different == 0 && boards >= 10 && ok;
+
+    std::cout << (ok ? "passed\n" : "FAILED\n");
+    return ok ? 0 : 1;
+}
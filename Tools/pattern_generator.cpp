@@ -0,0 +1,188 @@
+/*
+    Generates the table of pair-of-hint deductions used by find_pattern_move, see Solver/patterns.hpp.
+
+    Every possible pair is tried: any sizes for the three groups of cells that fit around two hints, and any values for the hints that the trivial
+    deductions can't settle on their own. For each one, every way of placing mines that satisfies both hints is counted by how many mines go in the shared
+    group, and a group is forced safe or forced mine if it is in all of them. The pairs that force anything are written out as a perfect hash table using
+    hash and displace: keys are split into buckets by one hash, and each bucket, largest first, is given the first seed that sends all of its keys to free
+    slots.
+
+    Run by the build, as: ./PatternGenerator OUTPUT_FILE
+*/
+
+#include "../Solver/patterns.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+const int MAX_SHARED = 4;       // Two hints side by side share 4 neighbors, and any other pair fewer
+const int MAX_SEED = 65535;
+
+// The flags forced on a pair of hints, or 0 if nothing is forced or no placement satisfies both.
+static uint32_t deduce(int only_first, int shared, int only_second, int first_value, int second_value)
+{
+    bool any = false;
+    bool first_safe = true, first_mine = true;
+    bool shared_safe = true, shared_mine = true;
+    bool second_safe = true, second_mine = true;
+
+    for(int k = 0; k <= shared; ++k)
+    {
+        int first_mines = first_value - k;
+        int second_mines = second_value - k;
+        if(first_mines < 0 || first_mines > only_first || second_mines < 0 || second_mines > only_second)
+        {
+            continue;
+        }
+
+        any = true;
+        first_safe = first_safe && first_mines == 0;
+        first_mine = first_mine && first_mines == only_first;
+        shared_safe = shared_safe && k == 0;
+        shared_mine = shared_mine && k == shared;
+        second_safe = second_safe && second_mines == 0;
+        second_mine = second_mine && second_mines == only_second;
+    }
+
+    if(!any)
+    {
+        return 0;
+    }
+
+    uint32_t flags = 0;
+    if(only_first > 0)
+    {
+        flags |= (first_safe ? PATTERN_FIRST_SAFE : 0) | (first_mine ? PATTERN_FIRST_MINE : 0);
+    }
+    if(shared > 0)
+    {
+        flags |= (shared_safe ? PATTERN_SHARED_SAFE : 0) | (shared_mine ? PATTERN_SHARED_MINE : 0);
+    }
+    if(only_second > 0)
+    {
+        flags |= (second_safe ? PATTERN_SECOND_SAFE : 0) | (second_mine ? PATTERN_SECOND_MINE : 0);
+    }
+    return flags;
+}
+
+int main(int argc, char **args)
+{
+    if(argc != 2)
+    {
+        std::cout << "Usage: ./PatternGenerator OUTPUT_FILE" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::pair<uint32_t, uint32_t> > entries;
+    for(int only_first = 0; only_first <= 8; ++only_first)
+    {
+        for(int shared = 1; shared <= MAX_SHARED && only_first + shared <= 8; ++shared)
+        {
+            for(int only_second = 0; shared + only_second <= 8; ++only_second)
+            {
+                for(int first_value = 1; first_value < only_first + shared; ++first_value)
+                {
+                    for(int second_value = 1; second_value < shared + only_second; ++second_value)
+                    {
+                        uint32_t flags = deduce(only_first, shared, only_second, first_value, second_value);
+                        if(flags)
+                        {
+                            entries.push_back({pattern_key(only_first, shared, only_second, first_value, second_value), flags});
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    int num_buckets = entries.size() / 4 + 1;
+    int num_slots = entries.size() + entries.size() / 8 + 1;
+
+    std::vector<std::vector<std::pair<uint32_t, uint32_t> > > buckets(num_buckets);
+    for(const std::pair<uint32_t, uint32_t>& entry : entries)
+    {
+        buckets[pattern_hash(entry.first, 0) % num_buckets].push_back(entry);
+    }
+
+    std::vector<int> order(num_buckets);
+    for(int bucket = 0; bucket < num_buckets; ++bucket)
+    {
+        order[bucket] = bucket;
+    }
+    std::stable_sort(order.begin(), order.end(), [&buckets](int a, int b) -> bool {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    std::vector<uint32_t> seeds(num_buckets);
+    std::vector<uint32_t> table(num_slots, PATTERN_EMPTY);
+    std::vector<int> slots;
+
+    for(int bucket : order)
+    {
+        if(buckets[bucket].empty())
+        {
+            break;
+        }
+
+        uint32_t seed = 1;
+        for(; seed <= MAX_SEED; ++seed)
+        {
+            slots.clear();
+            for(const std::pair<uint32_t, uint32_t>& entry : buckets[bucket])
+            {
+                int slot = pattern_hash(entry.first, seed) % num_slots;
+                if(table[slot] != PATTERN_EMPTY || std::find(slots.begin(), slots.end(), slot) != slots.end())
+                {
+                    break;
+                }
+                slots.push_back(slot);
+            }
+            if(slots.size() == buckets[bucket].size())
+            {
+                break;
+            }
+        }
+
+        if(seed > MAX_SEED)
+        {
+            std::cout << "PatternGenerator: no seed places bucket " << bucket << std::endl;
+            return 1;
+        }
+
+        seeds[bucket] = seed;
+        for(size_t i = 0; i < slots.size(); ++i)
+        {
+            table[slots[i]] = buckets[bucket][i].first << PATTERN_FLAG_BITS | buckets[bucket][i].second;
+        }
+    }
+
+    std::ofstream out(args[1]);
+    out << "// Generated by Tools/pattern_generator.cpp. Do not edit.\n\n";
+    out << "static const int PATTERN_BUCKETS = " << num_buckets << ";\n";
+    out << "static const int PATTERN_SLOTS = " << num_slots << ";\n\n";
+
+    out << "static const uint16_t PATTERN_SEEDS[PATTERN_BUCKETS] = {";
+    for(int bucket = 0; bucket < num_buckets; ++bucket)
+    {
+        out << (bucket % 16 ? " " : "\n    ") << seeds[bucket] << (bucket + 1 < num_buckets ? "," : "\n");
+    }
+    out << "};\n\n";
+
+    out << "static const uint32_t PATTERN_TABLE[PATTERN_SLOTS] = {";
+    for(int slot = 0; slot < num_slots; ++slot)
+    {
+        out << (slot % 8 ? " " : "\n    ") << "0x" << std::hex << table[slot] << std::dec << (slot + 1 < num_slots ? "," : "\n");
+    }
+    out << "};\n";
+
+    if(!out)
+    {
+        std::cout << "PatternGenerator: could not write " << args[1] << std::endl;
+        return 1;
+    }
+    return 0;
+}